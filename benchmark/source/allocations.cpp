@@ -0,0 +1,121 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/inplace_function.h>
+#include <thread_pool/recycling_memory_resource.h>
+#include <thread_pool/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    std::atomic_bool count_allocations{false};
+    std::atomic_size_t allocation_count{0};
+}  // namespace
+
+// replace the global allocation functions so that we can count heap allocations
+void* operator new(std::size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { ::operator delete(ptr); }
+
+// used by std::pmr::new_delete_resource()
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+inline void add_values(std::uint64_t a, std::uint64_t b, std::uint64_t c,
+                       std::atomic_uint64_t& result) {
+    result.fetch_add(a + b + c, std::memory_order_relaxed);
+}
+
+template <typename FunctionType, template <typename> typename Future = std::future>
+void run_allocation_benchmark(ankerl::nanobench::Bench& bench, const std::string& name,
+                              bool with_futures = false,
+                              std::pmr::memory_resource* resource = nullptr) {
+    constexpr auto task_count = 64'000;
+    std::atomic_uint64_t result{0};
+    dp::thread_pool<FunctionType> pool(dp::thread_pool_options{.memory_resource = resource});
+    std::vector<Future<void>> futures(task_count);
+
+    auto enqueue_tasks = [&] {
+        for (std::uint64_t i = 0; i < task_count; ++i) {
+            // the captures are larger than the small buffer of std::function
+            if (with_futures) {
+                futures[i] = pool.template enqueue<Future>(add_values, i, i + 1, i + 2,
+                                                           std::ref(result));
+            } else {
+                pool.enqueue_detach(add_values, i, i + 1, i + 2, std::ref(result));
+            }
+        }
+        pool.wait_for_tasks();
+        if (with_futures) {
+            for (auto& future : futures) future.get();
+        }
+    };
+
+    // warm up the queues before counting
+    enqueue_tasks();
+    allocation_count.store(0);
+    count_allocations.store(true);
+    enqueue_tasks();
+    count_allocations.store(false);
+
+    std::cout << name << ": "
+              << static_cast<double>(allocation_count.load()) / static_cast<double>(task_count)
+              << " heap allocations per task\n";
+
+    bench.run(name, enqueue_tasks);
+}
+
+TEST_CASE("dp::thread_pool allocations per task") {
+    using namespace std::chrono_literals;
+    ankerl::nanobench::Bench bench;
+    bench.title("allocations enqueue_detach 64,000")
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+
+    run_allocation_benchmark<std::function<void()>>(bench, "std::function");
+#ifdef __cpp_lib_move_only_function
+    run_allocation_benchmark<std::move_only_function<void()>>(bench, "std::move_only_function");
+#endif
+    run_allocation_benchmark<dp::inplace_function<void()>>(bench, "dp::inplace_function");
+
+    // the closures and the shared states of the futures are recycled by the memory resource,
+    // only std::function still allocates every closure on the heap
+    dp::recycling_memory_resource resource;
+    bench.title("allocations enqueue 64,000");
+    run_allocation_benchmark<std::function<void()>>(bench, "std::function + std::future", true);
+    run_allocation_benchmark<std::function<void()>>(
+        bench, "std::function + std::future + recycling_memory_resource", true, &resource);
+    run_allocation_benchmark<std::function<void()>, dp::future>(
+        bench, "std::function + dp::future + recycling_memory_resource", true, &resource);
+#ifdef __cpp_lib_move_only_function
+    run_allocation_benchmark<std::move_only_function<void()>, dp::future>(
+        bench, "std::move_only_function + dp::future + recycling_memory_resource", true,
+        &resource);
+#endif
+}
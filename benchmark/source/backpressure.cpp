@@ -0,0 +1,82 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <thread>
+
+namespace {
+    /**
+     * @brief Keeps track of the peak number of bytes allocated through it.
+     */
+    class peak_memory_resource : public std::pmr::memory_resource {
+      public:
+        void reset() { peak_.store(current_.load()); }
+        [[nodiscard]] std::size_t peak() const { return peak_.load(); }
+
+      private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            const auto current = current_.fetch_add(bytes) + bytes;
+            auto peak = peak_.load();
+            while (current > peak && !peak_.compare_exchange_weak(peak, current)) {
+            }
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+            current_.fetch_sub(bytes);
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::atomic_size_t current_{0};
+        std::atomic_size_t peak_{0};
+    };
+
+    std::uint64_t work(std::uint64_t value) {
+        for (int i = 0; i < 200; ++i) value = value * 31 + static_cast<std::uint64_t>(i);
+        return value;
+    }
+
+    void run_overload(ankerl::nanobench::Bench& bench, const std::string& name,
+                      std::size_t capacity, dp::overflow_policy overflow) {
+        constexpr auto task_count = 200'000;
+        peak_memory_resource memory;
+        std::atomic_uint64_t result{0};
+        dp::thread_pool pool(dp::thread_pool_options{
+            .thread_count = std::max(2u, std::thread::hardware_concurrency()) - 1,
+            .memory_resource = &memory,
+            .queue_capacity = capacity,
+            .overflow = overflow});
+
+        memory.reset();
+        bench.run(name, [&] {
+            // a single producer that outruns the workers
+            for (auto i = 0; i < task_count; ++i) {
+                pool.enqueue_detach([&result, i] {
+                    result.fetch_add(work(static_cast<std::uint64_t>(i)),
+                                     std::memory_order_relaxed);
+                });
+            }
+            pool.wait_for_tasks();
+        });
+        std::cout << name << ": peak task memory " << memory.peak() / 1024 << " KiB\n";
+    }
+}  // namespace
+
+TEST_CASE("overload: unbounded vs bounded queues") {
+    ankerl::nanobench::Bench bench;
+    bench.title("200,000 tasks from a producer faster than the workers").warmup(1).relative(true);
+
+    run_overload(bench, "unbounded", 0, dp::overflow_policy::block);
+    run_overload(bench, "capacity 1024, block", 1024, dp::overflow_policy::block);
+    run_overload(bench, "capacity 1024, caller_runs", 1024, dp::overflow_policy::caller_runs);
+}
@@ -0,0 +1,108 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/task.h>
+#include <thread_pool/task_graph.h>
+#include <thread_pool/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    constexpr auto step_count = 1'000;
+
+    std::uint64_t step(std::uint64_t value) {
+        for (int i = 0; i < 100; ++i) value = value * 31 + static_cast<std::uint64_t>(i);
+        return value;
+    }
+}  // namespace
+
+// a chain of dependent steps, each one needs the result of the previous one
+TEST_CASE("dependent steps: blocking vs continuations") {
+    ankerl::nanobench::Bench bench;
+    bench.title("chain of 1,000 dependent steps").warmup(3).relative(true);
+    dp::thread_pool pool(std::max(2u, std::thread::hardware_concurrency()));
+
+    bench.run("get() between steps", [&] {
+        std::uint64_t value = 1;
+        for (auto i = 0; i < step_count; ++i) {
+            value = pool.enqueue<dp::future>(step, value).get();
+        }
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+
+    bench.run("then()", [&] {
+        auto value = pool.enqueue<dp::future>(step, std::uint64_t{1});
+        for (auto i = 1; i < step_count; ++i) value = std::move(value).then(pool, step);
+        ankerl::nanobench::doNotOptimizeAway(value.get());
+    });
+
+    bench.run("dp::task with schedule()", [&] {
+        auto chain = [](auto& target) -> dp::task<std::uint64_t> {
+            std::uint64_t value = 1;
+            for (auto i = 0; i < step_count; ++i) {
+                co_await target.schedule();
+                value = step(value);
+            }
+            co_return value;
+        };
+        ankerl::nanobench::doNotOptimizeAway(dp::sync_wait(chain(pool)));
+    });
+
+    bench.run("dp::task_graph", [&] {
+        dp::task_graph graph;
+        std::uint64_t value = 1;
+        auto previous = graph.emplace([&value] { value = step(value); });
+        for (auto i = 1; i < step_count; ++i) {
+            auto next = graph.emplace([&value] { value = step(value); });
+            previous.precede(next);
+            previous = next;
+        }
+        graph.run(pool).get();
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+}
+
+// fork/join diamonds: one step fans out to several independent ones that are joined again
+TEST_CASE("fork/join diamonds: blocking vs when_all") {
+    constexpr auto diamond_count = 100;
+    constexpr auto width = 8;
+    ankerl::nanobench::Bench bench;
+    bench.title("100 diamonds of width 8").warmup(3).relative(true);
+    dp::thread_pool pool(std::max(2u, std::thread::hardware_concurrency()));
+
+    bench.run("get() on every branch", [&] {
+        std::uint64_t value = 1;
+        for (auto d = 0; d < diamond_count; ++d) {
+            std::vector<dp::future<std::uint64_t>> branches;
+            for (auto b = 0; b < width; ++b) {
+                branches.push_back(pool.enqueue<dp::future>(step, value + b));
+            }
+            for (auto& branch : branches) value += branch.get();
+        }
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+
+    bench.run("dp::task_graph", [&] {
+        dp::task_graph graph;
+        std::atomic_uint64_t value{1};
+        auto join = graph.emplace([] {});
+        for (auto d = 0; d < diamond_count; ++d) {
+            auto next = graph.emplace([] {});
+            for (auto b = 0; b < width; ++b) {
+                auto branch = graph.emplace([&value, b] {
+                    value.fetch_add(step(static_cast<std::uint64_t>(b)),
+                                    std::memory_order_relaxed);
+                });
+                join.precede(branch);
+                next.succeed(branch);
+            }
+            join = next;
+        }
+        graph.run(pool).get();
+        ankerl::nanobench::doNotOptimizeAway(value.load());
+    });
+}
@@ -1,5 +1,6 @@
 #include <doctest/doctest.h>
 #include <nanobench.h>
+#include <thread_pool/parallel.h>
 #include <thread_pool/thread_pool.h>
 #include <utilities.h>
 
@@ -54,6 +55,27 @@ std::uint64_t count_primes_thread_pool(const std::vector<ValueType>& values) {
     return count.load();
 }
 
+template <std::integral ValueType>
+std::uint64_t count_primes_parallel_for(const std::vector<ValueType>& values) {
+    std::atomic<std::uint64_t> count(0);
+
+    {
+        dp::thread_pool<> pool{};
+        dp::parallel_for(pool, std::size_t{0}, values.size(),
+                         [&](std::size_t i) { count_if_prime_tp(values[i], count); });
+    }
+
+    return count.load();
+}
+
+template <std::integral ValueType>
+std::uint64_t count_primes_parallel_reduce(const std::vector<ValueType>& values) {
+    dp::thread_pool<> pool{};
+    return dp::parallel_transform_reduce(
+        pool, values, std::uint64_t{0}, std::plus<>{},
+        [](const ValueType& value) -> std::uint64_t { return is_prime(value) ? 1 : 0; });
+}
+
 template <std::integral ValueType>
 void run_benchmark(const std::size_t& size) {
     ankerl::nanobench::Bench bench;
@@ -75,6 +97,24 @@ void run_benchmark(const std::size_t& size) {
         }
     });
 
+    count.store(0);
+    bench.run("dp::parallel_for", [&] {
+        dp::thread_pool<> pool{};
+        dp::parallel_for(pool, std::size_t{0}, values.size(),
+                         [&](std::size_t i) { count_if_prime_tp(values[i], count); });
+    });
+
+    count.store(0);
+    bench.run("dp::parallel_for_each grain 64", [&] {
+        dp::thread_pool<> pool{};
+        dp::parallel_for_each(
+            pool, values, [&](const ValueType& value) { count_if_prime_tp(value, count); }, 64);
+    });
+
+    bench.run("dp::parallel_transform_reduce", [&] {
+        ankerl::nanobench::doNotOptimizeAway(count_primes_parallel_reduce(values));
+    });
+
     count.store(0);
     bench.run("BS::thread_pool_light", [&] {
         BS::thread_pool_light bs_thread_pool{std::thread::hardware_concurrency()};
@@ -103,6 +143,8 @@ TEST_CASE("count primes") {
     auto pool_result = count_primes_thread_pool(values);
 
     CHECK(result == pool_result);
+    CHECK(result == count_primes_parallel_for(values));
+    CHECK(result == count_primes_parallel_reduce(values));
 
     std::vector<std::uint32_t> values2(100);
     generate_random_data(values2);
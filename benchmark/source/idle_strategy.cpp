@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/thread_pool.h>
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    const std::vector<std::pair<std::string, dp::idle_strategy>> strategies = {
+        {"park", {}},
+        {"yield 100", {.yield_count = 100}},
+        {"spin 10,000", {.spin_count = 10'000}},
+        {"spin 100,000 + yield 100", {.spin_count = 100'000, .yield_count = 100}},
+    };
+}  // namespace
+
+// round trip of a single task on an otherwise idle pool, i.e. the time to wake up a worker
+TEST_CASE("dp::thread_pool wake latency") {
+    using namespace std::chrono_literals;
+    ankerl::nanobench::Bench bench;
+
+    // clang-format off
+    bench.title("wake latency")
+        .warmup(100)
+        .minEpochIterations(1000)
+        .relative(true)
+        .timeUnit(1us, "us");
+    // clang-format on
+
+    for (const auto& [name, strategy] : strategies) {
+        dp::thread_pool pool({.thread_count = 4, .idle = strategy});
+        bench.run(name, [&] { pool.enqueue<dp::future>([] { return 1; }).get(); });
+    }
+}
+
+// CPU time used by the whole process while the pool has nothing to do
+TEST_CASE("dp::thread_pool idle CPU usage") {
+    using namespace std::chrono_literals;
+    constexpr auto idle_time = 200ms;
+
+    for (const auto& [name, strategy] : strategies) {
+        dp::thread_pool pool({.thread_count = 4, .idle = strategy});
+        // a short burst of work, after which the workers go idle
+        for (int i = 0; i < 1000; ++i) pool.enqueue_detach([] {});
+        pool.wait_for_tasks();
+
+        const auto cpu_start = std::clock();
+        std::this_thread::sleep_for(idle_time);
+        const auto cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_start) /
+                            static_cast<double>(CLOCKS_PER_SEC);
+
+        std::cout << name << ": " << cpu_ms << " ms CPU time in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(idle_time).count()
+                  << " ms while idle\n";
+    }
+}
@@ -0,0 +1,73 @@
+#include <doctest/doctest.h>
+#include <thread_pool/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    void busy_wait(std::chrono::microseconds duration) {
+        const auto end = clock_type::now() + duration;
+        while (clock_type::now() < end) {
+        }
+    }
+
+    // re-enqueues itself until stopped, so the number of queued background tasks stays constant
+    template <typename Pool>
+    void background_task(Pool& pool, const std::atomic_bool& stop) {
+        busy_wait(std::chrono::microseconds(20));
+        if (!stop.load(std::memory_order_relaxed)) {
+            pool.enqueue_detach(background_task<Pool>, std::ref(pool), std::cref(stop));
+        }
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        std::ranges::sort(values);
+        const auto index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+        return values[index];
+    }
+}  // namespace
+
+// time from enqueue until a task starts running while every worker has a deep backlog of
+// background tasks
+TEST_CASE("dp::thread_pool priority latency under load") {
+    constexpr auto backlog_per_worker = 64;
+    constexpr auto probe_count = 200;
+    const auto thread_count = std::max(2u, std::thread::hardware_concurrency());
+
+    for (const auto& [name, probe_priority] :
+         {std::pair{"normal", dp::priority::normal}, std::pair{"high", dp::priority::high}}) {
+        dp::thread_pool pool(thread_count);
+        std::atomic_bool stop{false};
+        for (unsigned int i = 0; i < thread_count * backlog_per_worker; ++i) {
+            pool.enqueue_detach(background_task<decltype(pool)>, std::ref(pool), std::cref(stop));
+        }
+
+        std::vector<double> latencies;
+        for (auto probe = 0; probe < probe_count; ++probe) {
+            const auto enqueued = clock_type::now();
+            const auto started = pool.enqueue<dp::future>(probe_priority, [] {
+                                         return clock_type::now();
+                                     }).get();
+            latencies.push_back(
+                std::chrono::duration<double, std::micro>(started - enqueued).count());
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        stop.store(true);
+        pool.wait_for_tasks();
+
+        std::cout << name << " priority: p50 " << percentile(latencies, 0.5) << " us, p99 "
+                  << percentile(latencies, 0.99) << " us, max "
+                  << *std::ranges::max_element(latencies) << " us\n";
+    }
+}
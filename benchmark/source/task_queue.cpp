@@ -0,0 +1,198 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/thread_pool.h>
+#include <thread_pool/thread_safe_queue.h>
+#include <thread_pool/work_stealing_deque.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename Queue>
+void push_then_pop(Queue& queue, const std::size_t& count) {
+    for (std::size_t i = 0; i < count; ++i) queue.push_back(std::size_t(i));
+    std::size_t sum = 0;
+    while (auto item = queue.pop_front()) sum += *item;
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+// one owner pushes and pops items while the remaining threads steal from it
+template <typename Queue>
+void owner_and_thieves(const std::size_t& item_count, const unsigned int& thief_count) {
+    Queue queue;
+    std::atomic_size_t taken{0};
+    {
+        std::vector<std::jthread> thieves;
+        for (unsigned int t = 0; t < thief_count; ++t) {
+            thieves.emplace_back([&] {
+                while (taken.load(std::memory_order_relaxed) < item_count) {
+                    if (queue.steal()) taken.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        for (std::size_t i = 0; i < item_count; ++i) {
+            queue.push_back(std::size_t(i));
+            if (queue.pop_front()) taken.fetch_add(1, std::memory_order_relaxed);
+        }
+        while (taken.load(std::memory_order_relaxed) < item_count) {
+            if (queue.pop_front()) taken.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline void small_task(std::atomic_uint64_t& counter) {
+    std::uint64_t value = 1;
+    for (int i = 0; i < 100; ++i) value = value * 31 + static_cast<std::uint64_t>(i);
+    ankerl::nanobench::doNotOptimizeAway(value);
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+TEST_CASE("task queue single thread") {
+    ankerl::nanobench::Bench bench;
+    constexpr std::size_t count = 100'000;
+    bench.title("task queue push/pop 100,000").warmup(10).relative(true);
+
+    bench.run("dp::thread_safe_queue", [&] {
+        dp::thread_safe_queue<std::size_t> queue;
+        push_then_pop(queue, count);
+    });
+
+    bench.run("dp::work_stealing_deque", [&] {
+        dp::work_stealing_deque<std::size_t> queue;
+        push_then_pop(queue, count);
+    });
+}
+
+TEST_CASE("task queue owner and thieves") {
+    using namespace std::chrono_literals;
+    constexpr std::size_t count = 200'000;
+
+    const auto max_thieves = std::max(1u, std::thread::hardware_concurrency() - 1);
+    for (unsigned int thieves = 1; thieves <= max_thieves; thieves *= 2) {
+        ankerl::nanobench::Bench bench;
+        bench.title("task queue 200,000 with " + std::to_string(thieves) + " thieves")
+            .warmup(2)
+            .relative(true)
+            .timeUnit(1ms, "ms");
+
+        bench.run("dp::thread_safe_queue",
+                  [&] { owner_and_thieves<dp::thread_safe_queue<std::size_t>>(count, thieves); });
+        bench.run("dp::work_stealing_deque",
+                  [&] { owner_and_thieves<dp::work_stealing_deque<std::size_t>>(count, thieves); });
+    }
+}
+
+TEST_CASE("dp::thread_pool task queue types") {
+    using namespace std::chrono_literals;
+    using function_type = dp::details::default_function_type;
+    constexpr auto task_count = 64'000;
+
+    ankerl::nanobench::Bench bench;
+    bench.title("thread_pool queue types 64,000")
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+
+    std::atomic_uint64_t counter{0};
+    {
+        dp::thread_pool<function_type, std::jthread, dp::thread_safe_queue<function_type>> pool{};
+        bench.run("dp::thread_safe_queue", [&] {
+            for (auto i = 0; i < task_count; ++i) pool.enqueue_detach(small_task, std::ref(counter));
+            pool.wait_for_tasks();
+        });
+    }
+
+    {
+        dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>> pool{};
+        bench.run("dp::work_stealing_deque", [&] {
+            for (auto i = 0; i < task_count; ++i) pool.enqueue_detach(small_task, std::ref(counter));
+            pool.wait_for_tasks();
+        });
+    }
+}
+
+// hides steal_batch() so that the pool falls back to stealing a single task at a time
+template <typename Queue>
+class single_steal_queue : public Queue {
+  public:
+    using Queue::Queue;
+    std::optional<typename Queue::value_type> steal_batch(single_steal_queue&) = delete;
+};
+
+template <typename Queue>
+void run_imbalanced_load(ankerl::nanobench::Bench& bench, const std::string& name) {
+    using function_type = dp::details::default_function_type;
+    constexpr auto task_count = 64'000;
+    std::atomic_uint64_t counter{0};
+
+    dp::thread_pool<function_type, std::jthread, Queue> pool{};
+    bench.run(name, [&] {
+        // every task ends up in the queue of the single worker that runs the producer, so all
+        // other workers only get work by stealing
+        pool.enqueue_detach([&] {
+            for (auto i = 0; i < task_count; ++i) pool.enqueue_detach(small_task, std::ref(counter));
+        });
+        pool.wait_for_tasks();
+    });
+}
+
+TEST_CASE("dp::thread_pool imbalanced load") {
+    using namespace std::chrono_literals;
+    using function_type = dp::details::default_function_type;
+
+    ankerl::nanobench::Bench bench;
+    bench.title("imbalanced load 64,000")
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+
+    run_imbalanced_load<single_steal_queue<dp::thread_safe_queue<function_type>>>(
+        bench, "dp::thread_safe_queue steal");
+    run_imbalanced_load<dp::thread_safe_queue<function_type>>(bench,
+                                                              "dp::thread_safe_queue steal_batch");
+    run_imbalanced_load<single_steal_queue<dp::work_stealing_deque<function_type>>>(
+        bench, "dp::work_stealing_deque steal");
+    run_imbalanced_load<dp::work_stealing_deque<function_type>>(
+        bench, "dp::work_stealing_deque steal_batch");
+}
+
+TEST_CASE("dp::thread_pool victim selection") {
+    using namespace std::chrono_literals;
+    constexpr auto task_count = 64'000;
+    constexpr auto producer_count = 4;
+
+    ankerl::nanobench::Bench bench;
+    bench.title("victim selection 4 x 16,000")
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+
+    for (const auto& [name, policy] :
+         {std::pair{"sequential", dp::victim_selection::sequential},
+          std::pair{"randomized", dp::victim_selection::randomized},
+          std::pair{"topology", dp::victim_selection::topology}}) {
+        std::atomic_uint64_t counter{0};
+        dp::thread_pool pool({.thread_count = std::thread::hardware_concurrency(),
+                              .victims = policy});
+        bench.run(name, [&] {
+            // a few workers produce all tasks, so the remaining ones compete for the same victims
+            for (auto p = 0; p < producer_count; ++p) {
+                pool.enqueue_detach([&] {
+                    for (auto i = 0; i < task_count / producer_count; ++i) {
+                        pool.enqueue_detach(small_task, std::ref(counter));
+                    }
+                });
+            }
+            pool.wait_for_tasks();
+        });
+    }
+}
@@ -3,8 +3,11 @@
 #include <thread_pool/thread_pool.h>
 
 #include <chrono>
+#include <ranges>
 #include <riften/thiefpool.hpp>
+#include <string>
 #include <thread>
+#include <vector>
 
 inline void thread_task() {
     int a = 0;
@@ -77,3 +80,178 @@ TEST_CASE("riften::ThiefPool scaling") {
         });
     }
 }
+
+template <typename Pool>
+void spawn_tree(Pool& pool, int level) {
+    thread_task();
+    if (level == 0) return;
+    pool.enqueue_detach([&pool, level] { spawn_tree(pool, level - 1); });
+    pool.enqueue_detach([&pool, level] { spawn_tree(pool, level - 1); });
+}
+
+// tasks that enqueue more tasks from inside the pool (fork-join style)
+TEST_CASE("dp::thread_pool recursive enqueue scaling") {
+    using namespace std::chrono_literals;
+    ankerl::nanobench::Bench bench;
+    const auto bench_title = std::string("recursive enqueue 65,535");
+
+    // clang-format off
+    bench.title(bench_title)
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+    // clang-format on
+
+    for (unsigned int n_threads = 1; n_threads <= std::thread::hardware_concurrency();
+         n_threads++) {
+        const std::string run_title = "dp::thread_pool n_threads: " + std::to_string(n_threads);
+        dp::thread_pool pool{n_threads};
+        bench.run(run_title, [&] {
+            pool.enqueue_detach([&pool] { spawn_tree(pool, 15); });
+            pool.wait_for_tasks();
+        });
+    }
+}
+
+// several external threads enqueue into the same pool at the same time
+TEST_CASE("dp::thread_pool multi-producer enqueue") {
+    using namespace std::chrono_literals;
+    constexpr auto total_tasks = 64'000;
+    ankerl::nanobench::Bench bench;
+    const auto bench_title = std::string("multi-producer enqueue 64,000");
+
+    // clang-format off
+    bench.title(bench_title)
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+    // clang-format on
+
+    dp::thread_pool pool{};
+    for (unsigned int n_producers = 1; n_producers <= std::thread::hardware_concurrency();
+         n_producers *= 2) {
+        const std::string run_title = "dp::thread_pool producers: " + std::to_string(n_producers);
+        bench.run(run_title, [&] {
+            {
+                std::vector<std::jthread> producers;
+                for (unsigned int p = 0; p < n_producers; ++p) {
+                    producers.emplace_back([&pool, n_producers] {
+                        for (unsigned int i = 0; i < total_tasks / n_producers; i++) {
+                            pool.enqueue_detach(thread_task);
+                        }
+                    });
+                }
+            }
+            pool.wait_for_tasks();
+        });
+    }
+}
+
+TEST_CASE("dp::thread_pool bulk enqueue") {
+    using namespace std::chrono_literals;
+    constexpr auto total_tasks = 64'000;
+    ankerl::nanobench::Bench bench;
+    const auto bench_title = std::string("bulk enqueue 64,000");
+
+    // clang-format off
+    bench.title(bench_title)
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+    // clang-format on
+
+    dp::thread_pool pool{};
+    bench.run("dp::thread_pool enqueue_detach", [&] {
+        for (auto i = 0; i < total_tasks; i++) {
+            pool.enqueue_detach(thread_task);
+        }
+        pool.wait_for_tasks();
+    });
+
+    bench.run("dp::thread_pool enqueue_detach_bulk", [&] {
+        pool.enqueue_detach_bulk(std::views::iota(0, total_tasks) |
+                                 std::views::transform([](int) { return thread_task; }));
+        pool.wait_for_tasks();
+    });
+
+    std::vector<std::future<void>> results(total_tasks);
+    bench.run("dp::thread_pool enqueue", [&] {
+        for (auto i = 0; i < total_tasks; i++) {
+            results[i] = pool.enqueue(thread_task);
+        }
+        for (auto& result : results) result.get();
+    });
+
+    bench.run("dp::thread_pool enqueue_bulk", [&] {
+        results = pool.enqueue_bulk(std::views::iota(0, total_tasks) |
+                                    std::views::transform([](int) { return thread_task; }));
+        for (auto& result : results) result.get();
+    });
+}
+
+TEST_CASE("dp::thread_pool future types") {
+    using namespace std::chrono_literals;
+    constexpr auto total_tasks = 64'000;
+    ankerl::nanobench::Bench bench;
+    const auto bench_title = std::string("enqueue + get 64,000");
+
+    // clang-format off
+    bench.title(bench_title)
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+    // clang-format on
+
+    dp::thread_pool pool{};
+    std::vector<std::future<int>> std_results(total_tasks);
+    bench.run("std::future", [&] {
+        for (auto i = 0; i < total_tasks; i++) {
+            std_results[i] = pool.enqueue([i] { return i; });
+        }
+        for (auto& result : std_results) ankerl::nanobench::doNotOptimizeAway(result.get());
+    });
+
+    std::vector<dp::future<int>> dp_results(total_tasks);
+    bench.run("dp::future", [&] {
+        for (auto i = 0; i < total_tasks; i++) {
+            dp_results[i] = pool.enqueue<dp::future>([i] { return i; });
+        }
+        for (auto& result : dp_results) ankerl::nanobench::doNotOptimizeAway(result.get());
+    });
+}
+
+// many tiny tasks, so the cost is dominated by the shared state of the pool and its workers.
+// benchmark/CMakeLists.txt also builds this file with TP_CACHE_LINE_SIZE set to
+// alignof(std::max_align_t), i.e. without padding, compare the results of both executables to
+// see the effect of dp::details::cache_line_size.
+TEST_CASE("dp::thread_pool tiny task throughput") {
+    using namespace std::chrono_literals;
+    constexpr auto total_tasks = 256'000;
+    ankerl::nanobench::Bench bench;
+    const auto bench_title = "tiny tasks 256,000, cache_line_size: " +
+                             std::to_string(dp::details::cache_line_size);
+
+    // clang-format off
+    bench.title(bench_title)
+        .warmup(10)
+        .minEpochIterations(10)
+        .relative(true)
+        .timeUnit(1ms, "ms");
+    // clang-format on
+
+    for (unsigned int n_threads = 1; n_threads <= std::thread::hardware_concurrency();
+         n_threads++) {
+        dp::thread_pool pool{n_threads};
+        bench.run("dp::thread_pool n_threads: " + std::to_string(n_threads), [&] {
+            // enqueued from a worker, so the other workers get their tasks by stealing
+            pool.enqueue_detach([&pool] {
+                for (auto i = 0; i < total_tasks; i++) pool.enqueue_detach([] {});
+            });
+            pool.wait_for_tasks();
+        });
+    }
+}
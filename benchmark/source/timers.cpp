@@ -0,0 +1,41 @@
+#include <doctest/doctest.h>
+#include <nanobench.h>
+#include <thread_pool/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <tuple>
+
+// many short timers, e.g. retries with a small backoff
+TEST_CASE("delayed tasks: sleeping task vs timer wheel") {
+    using namespace std::chrono_literals;
+    constexpr auto timer_count = 1'000;
+
+    ankerl::nanobench::Bench bench;
+    bench.title("1,000 tasks delayed by 1ms").warmup(1).relative(true);
+    dp::thread_pool pool(std::max(2u, std::thread::hardware_concurrency()));
+    std::atomic_int counter{0};
+
+    bench.run("sleep in a task", [&] {
+        counter.store(0);
+        for (auto i = 0; i < timer_count; ++i) {
+            pool.enqueue_detach([&counter] {
+                std::this_thread::sleep_for(1ms);
+                counter.fetch_add(1);
+            });
+        }
+        pool.wait_for_tasks();
+        ankerl::nanobench::doNotOptimizeAway(counter.load());
+    });
+
+    bench.run("enqueue_after()", [&] {
+        counter.store(0);
+        for (auto i = 0; i < timer_count; ++i) {
+            std::ignore = pool.enqueue_after(1ms, [&counter] { counter.fetch_add(1); });
+        }
+        while (counter.load() < timer_count) std::this_thread::yield();
+        pool.wait_for_tasks();
+    });
+}
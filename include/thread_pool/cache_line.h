@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dp::details {
+    /**
+     * @brief Alignment used to keep data written by different threads on separate cache lines.
+     * @details std::hardware_destructive_interference_size is not used because GCC warns about
+     * its use in headers (its value may change between compiler versions and is part of the ABI).
+     * x86-64 prefetches cache lines in adjacent pairs and many AArch64 cores have 128 byte lines,
+     * so 128 bytes are used there, 64 bytes everywhere else. Define `TP_CACHE_LINE_SIZE` to
+     * override it, e.g. with `alignof(std::max_align_t)` to measure the cost of false sharing.
+     * It must be the same in every translation unit.
+     */
+#if defined(TP_CACHE_LINE_SIZE)
+    inline constexpr std::size_t cache_line_size = TP_CACHE_LINE_SIZE;
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)
+    inline constexpr std::size_t cache_line_size = 128;
+#else
+    inline constexpr std::size_t cache_line_size = 64;
+#endif
+}  // namespace dp::details
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#    include <sched.h>
+#endif
+
+namespace dp::details {
+    inline bool parse_int(std::string_view text, int &value) {
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return !text.empty() && result.ec == std::errc{} &&
+               result.ptr == text.data() + text.size();
+    }
+
+    /**
+     * @brief Parse a Linux CPU list like "0-3,8,10-11".
+     */
+    inline std::vector<int> parse_cpu_list(std::string_view list) {
+        std::vector<int> cpus;
+
+        while (!list.empty()) {
+            const auto comma = list.find(',');
+            auto range = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            while (!range.empty() && (range.back() == '\n' || range.back() == ' ')) {
+                range.remove_suffix(1);
+            }
+            if (range.empty()) continue;
+
+            const auto dash = range.find('-');
+            int first = 0;
+            int last = 0;
+            if (!parse_int(range.substr(0, dash), first)) return {};
+            if (dash == std::string_view::npos) {
+                last = first;
+            } else if (!parse_int(range.substr(dash + 1), last)) {
+                return {};
+            }
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    /**
+     * @brief Which CPUs share a core, a last level cache and a NUMA node.
+     */
+    class cpu_topology {
+      public:
+        /// number of distinct values returned by distance()
+        static constexpr std::size_t distance_levels = 4;
+
+        cpu_topology() = default;
+
+        /**
+         * @brief Describe a CPU, CPUs with equal ids share the corresponding resource.
+         * Negative ids are unknown and never shared.
+         */
+        void add_cpu(int cpu, int core, int cache, int node) {
+            if (cpu < 0) return;
+            if (static_cast<std::size_t>(cpu) >= cpus_.size()) cpus_.resize(cpu + 1);
+            cpus_[cpu] = {core, cache, node};
+        }
+
+        /**
+         * @brief Read the topology from the Linux sysfs, returns an empty topology if it is
+         * not available.
+         */
+        static cpu_topology read(const std::filesystem::path &root = "/sys/devices/system/cpu") {
+            cpu_topology topology;
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(root, error)) {
+                const auto name = entry.path().filename().string();
+                int cpu = -1;
+                if (!name.starts_with("cpu") || !parse_int(name.substr(3), cpu)) continue;
+
+                const auto &path = entry.path();
+                // core_cpus_list replaced thread_siblings_list in newer kernels
+                auto core = first_cpu(read_file(path / "topology" / "core_cpus_list"));
+                if (core < 0) {
+                    core = first_cpu(read_file(path / "topology" / "thread_siblings_list"));
+                }
+                topology.add_cpu(cpu, core, last_level_cache(path), numa_node(path));
+            }
+            return topology;
+        }
+
+        [[nodiscard]] bool empty() const { return cpus_.empty(); }
+
+        /**
+         * @brief The core of @p cpu, identified by its first CPU, or -1 if unknown.
+         */
+        [[nodiscard]] int core(int cpu) const { return known(cpu) ? cpus_[cpu].core : -1; }
+
+        /**
+         * @brief The NUMA node of @p cpu or -1 if unknown.
+         */
+        [[nodiscard]] int node(int cpu) const { return known(cpu) ? cpus_[cpu].node : -1; }
+
+        /**
+         * @brief 0 if both CPUs share a core, 1 if they share a last level cache, 2 if they
+         * are on the same NUMA node and 3 otherwise (or if unknown).
+         */
+        [[nodiscard]] std::size_t distance(int first, int second) const {
+            if (!known(first) || !known(second)) return distance_levels - 1;
+            const auto &a = cpus_[first];
+            const auto &b = cpus_[second];
+            if (a.core >= 0 && a.core == b.core) return 0;
+            if (a.cache >= 0 && a.cache == b.cache) return 1;
+            if (a.node >= 0 && a.node == b.node) return 2;
+            return distance_levels - 1;
+        }
+
+      private:
+        struct cpu_info {
+            int core{-1};
+            int cache{-1};
+            int node{-1};
+        };
+
+        [[nodiscard]] bool known(int cpu) const {
+            return cpu >= 0 && static_cast<std::size_t>(cpu) < cpus_.size();
+        }
+
+        static std::string read_file(const std::filesystem::path &path) {
+            std::ifstream file(path);
+            std::string content;
+            std::getline(file, content);
+            return content;
+        }
+
+        static int first_cpu(std::string_view list) {
+            const auto cpus = parse_cpu_list(list);
+            return cpus.empty() ? -1 : *std::ranges::min_element(cpus);
+        }
+
+        /// identify the highest level data or unified cache by its first CPU
+        static int last_level_cache(const std::filesystem::path &cpu_path) {
+            int best_level = -1;
+            int cache = -1;
+            std::error_code error;
+            for (const auto &entry :
+                 std::filesystem::directory_iterator(cpu_path / "cache", error)) {
+                if (!entry.path().filename().string().starts_with("index")) continue;
+                int level = -1;
+                if (!parse_int(read_file(entry.path() / "level"), level)) continue;
+                if (read_file(entry.path() / "type") == "Instruction") continue;
+                if (level > best_level) {
+                    best_level = level;
+                    cache = first_cpu(read_file(entry.path() / "shared_cpu_list"));
+                }
+            }
+            return cache;
+        }
+
+        static int numa_node(const std::filesystem::path &cpu_path) {
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(cpu_path, error)) {
+                const auto name = entry.path().filename().string();
+                int node = -1;
+                if (name.starts_with("node") && parse_int(name.substr(4), node)) {
+                    return node;
+                }
+            }
+            return -1;
+        }
+
+        std::vector<cpu_info> cpus_{};
+    };
+
+    /**
+     * @brief The CPU the calling thread is running on, or -1 if unknown.
+     */
+    inline int current_cpu() {
+#ifdef __linux__
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+}  // namespace dp::details
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+
+namespace dp::details {
+    /**
+     * @brief Invokes a callback when the task that owns it is destroyed without having run.
+     * @details Queued tasks can be dropped, e.g. by dp::thread_pool::clear_tasks() or when
+     * enqueuing them fails, but whoever waits for them still has to be released. The task calls
+     * dismiss() when it starts. The guard is copyable so that it can be part of tasks stored in a
+     * std::function, a copy takes over the responsibility from the original (the pool itself only
+     * ever moves tasks).
+     */
+    template <typename Callback>
+    class drop_guard {
+      public:
+        explicit drop_guard(Callback callback) : callback_(std::move(callback)) {}
+
+        drop_guard(drop_guard &&other) noexcept
+            : callback_(std::move(other.callback_)), armed_(std::exchange(other.armed_, false)) {}
+        drop_guard(const drop_guard &other)
+            : callback_(other.callback_), armed_(std::exchange(other.armed_, false)) {}
+        drop_guard &operator=(const drop_guard &) = delete;
+        drop_guard &operator=(drop_guard &&) = delete;
+
+        ~drop_guard() {
+            if (armed_) std::invoke(callback_);
+        }
+
+        /**
+         * @brief The task is running, so the callback must not be invoked.
+         */
+        void dismiss() noexcept { armed_ = false; }
+
+      private:
+        Callback callback_;
+        mutable bool armed_{true};
+    };
+}  // namespace dp::details
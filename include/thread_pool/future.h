@@ -0,0 +1,597 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "worker_context.h"
+
+namespace dp {
+    template <typename T>
+    class future;
+
+    template <typename T>
+    class promise;
+
+    namespace details {
+        /**
+         * @brief A callback that runs once the result of a shared state is set.
+         */
+        struct continuation {
+            /// invokes the callback and frees the continuation
+            void (*run)(continuation *self);
+        };
+
+        /// marks a shared state whose result was published, no continuation can be added anymore
+        inline constinit continuation published_continuation{nullptr};
+
+        template <typename Callback>
+        struct continuation_node : continuation {
+            continuation_node(std::pmr::memory_resource *memory, Callback function)
+                : continuation{&invoke}, resource(memory), callback(std::move(function)) {}
+
+            static void invoke(continuation *self) {
+                auto *node = static_cast<continuation_node *>(self);
+                auto function = std::move(node->callback);
+                std::pmr::polymorphic_allocator<>(node->resource).delete_object(node);
+                std::invoke(function);
+            }
+
+            std::pmr::memory_resource *resource;
+            Callback callback;
+        };
+
+        /**
+         * @brief State shared between dp::promise and dp::future.
+         * @details A single allocation holds the reference counts, the result and an atomic state
+         * word. Waiting is done with std::atomic::wait (a futex on Linux) and the setter only
+         * notifies if a waiter has announced itself. Instead of waiting, a single continuation
+         * can be attached that the setter runs right after publishing the result.
+         */
+        template <typename T>
+        class shared_state {
+          public:
+            explicit shared_state(std::pmr::memory_resource *resource) : resource_(resource) {}
+
+            static shared_state *create(std::pmr::memory_resource *resource) {
+                return std::pmr::polymorphic_allocator<>(resource).new_object<shared_state>(
+                    resource);
+            }
+
+            using storage_type = std::conditional_t<
+                std::is_void_v<T>, std::monostate,
+                std::conditional_t<std::is_reference_v<T>,
+                                   std::reference_wrapper<std::remove_reference_t<T>>, T>>;
+
+            static constexpr std::uint32_t pending = 0;
+            static constexpr std::uint32_t ready = 1;
+            static constexpr std::uint32_t waiting = 2;
+
+            void add_reference() { references_.fetch_add(1, std::memory_order_relaxed); }
+
+            void release() {
+                if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::pmr::polymorphic_allocator<>(resource_).delete_object(this);
+                }
+            }
+
+            /**
+             * @brief Add the reference held by the future, which can only be retrieved once.
+             */
+            void retrieve_future() {
+                if (future_retrieved_.test_and_set(std::memory_order_relaxed)) {
+                    throw std::future_error(std::future_errc::future_already_retrieved);
+                }
+                add_reference();
+            }
+
+            void add_promise() { promises_.fetch_add(1, std::memory_order_relaxed); }
+
+            /**
+             * @brief Release a promise reference, breaking the promise if it was the last one and
+             * no result was set.
+             */
+            void release_promise() {
+                if (promises_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+                    !result_set_.test(std::memory_order_acquire)) {
+                    set_exception(std::make_exception_ptr(
+                        std::future_error(std::future_errc::broken_promise)));
+                }
+                release();
+            }
+
+            template <typename... Args>
+            void set_value(Args &&...args) {
+                claim_result();
+                result_.template emplace<1>(std::forward<Args>(args)...);
+                publish();
+            }
+
+            void set_exception(std::exception_ptr exception) {
+                claim_result();
+                result_.template emplace<2>(std::move(exception));
+                publish();
+            }
+
+            [[nodiscard]] bool is_ready() const {
+                return (state_.load(std::memory_order_acquire) & ready) != 0;
+            }
+
+            [[nodiscard]] std::pmr::memory_resource *resource() const { return resource_; }
+
+            /**
+             * @brief Invoke @p callback once the result is available: right away on the calling
+             * thread if it already is, otherwise on the thread that sets it. Only one callback
+             * can be attached and it must not throw.
+             */
+            template <typename Callback>
+            void set_continuation(Callback &&callback) {
+                if (continuation_.load(std::memory_order_acquire) == &published_continuation) {
+                    std::invoke(callback);
+                    return;
+                }
+                using node_type = continuation_node<std::decay_t<Callback>>;
+                continuation *node = std::pmr::polymorphic_allocator<>(resource_)
+                                         .new_object<node_type>(
+                                             resource_, std::forward<Callback>(callback));
+                continuation *expected = nullptr;
+                if (!continuation_.compare_exchange_strong(expected, node,
+                                                           std::memory_order_acq_rel)) {
+                    // the result was published in the meantime
+                    node->run(node);
+                }
+            }
+
+            void wait() {
+                // a worker thread runs pending tasks instead, the result may depend on them
+                if (!is_ready() && details::help_while_waiting([this] { return is_ready(); })) {
+                    return;
+                }
+                auto state = state_.load(std::memory_order_acquire);
+                while ((state & ready) == 0) {
+                    // announce that we are waiting so that the setter knows it has to notify
+                    if (state == pending && !state_.compare_exchange_weak(
+                                                state, waiting, std::memory_order_acq_rel)) {
+                        continue;
+                    }
+                    state_.wait(waiting, std::memory_order_acquire);
+                    state = state_.load(std::memory_order_acquire);
+                }
+            }
+
+            T get() {
+                wait();
+                if (result_.index() == 2) std::rethrow_exception(std::get<2>(result_));
+                if constexpr (std::is_void_v<T>) {
+                    return;
+                } else if constexpr (std::is_reference_v<T>) {
+                    return std::get<1>(result_).get();
+                } else {
+                    return std::move(std::get<1>(result_));
+                }
+            }
+
+          private:
+            void claim_result() {
+                if (result_set_.test_and_set(std::memory_order_acq_rel)) {
+                    throw std::future_error(std::future_errc::promise_already_satisfied);
+                }
+            }
+
+            void publish() {
+                if (state_.exchange(ready, std::memory_order_seq_cst) == waiting) {
+                    state_.notify_all();
+                }
+                details::notify_waiting_workers();
+                auto *next = continuation_.exchange(&published_continuation,
+                                                    std::memory_order_acq_rel);
+                if (next != nullptr) next->run(next);
+            }
+
+            std::pmr::memory_resource *resource_;
+            std::atomic<std::uint32_t> state_{pending};
+            std::atomic<std::uint32_t> references_{1};
+            std::atomic<std::uint32_t> promises_{1};
+            std::atomic_flag result_set_{};
+            std::atomic_flag future_retrieved_{};
+            std::atomic<continuation *> continuation_{nullptr};
+            std::variant<std::monostate, storage_type, std::exception_ptr> result_{};
+        };
+
+        struct future_access;
+
+        /**
+         * @brief Whether a continuation of a `future<T>` takes the result rather than the
+         * future itself.
+         */
+        template <typename Function, typename T>
+        concept takes_result = (std::is_void_v<T> && std::invocable<Function>) ||
+                               (!std::is_void_v<T> && std::invocable<Function, T>);
+
+        template <typename Function, typename T>
+        decltype(auto) invoke_continuation(Function &function, future<T> &antecedent) {
+            if constexpr (!takes_result<Function &, T>) {
+                return std::invoke(function, std::move(antecedent));
+            } else if constexpr (std::is_void_v<T>) {
+                antecedent.get();
+                return std::invoke(function);
+            } else {
+                return std::invoke(function, antecedent.get());
+            }
+        }
+
+        /**
+         * @brief Set the result of @p target to the result of @p function or to the exception
+         * it throws.
+         */
+        template <typename T, typename Function>
+        void fulfill(promise<T> &target, Function &&function) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    std::invoke(function);
+                    target.set_value();
+                } else {
+                    target.set_value(std::invoke(function));
+                }
+            } catch (...) {
+                target.set_exception(std::current_exception());
+            }
+        }
+    }  // namespace details
+
+    /**
+     * @brief Lightweight alternative to std::future.
+     * @details Obtained from dp::promise::get_future() or from dp::thread_pool::enqueue, e.g.
+     * `pool.enqueue<dp::future>(f, args...)`. Unlike std::future, the shared state is a single
+     * allocation without a mutex or condition variable. Dependent work can be chained with
+     * @ref then(), dp::when_all() and dp::when_any() instead of blocking on the result.
+     */
+    template <typename T>
+    class future {
+      public:
+        future() noexcept = default;
+        future(future &&other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+        future &operator=(future &&other) noexcept {
+            if (this != std::addressof(other)) {
+                reset();
+                state_ = std::exchange(other.state_, nullptr);
+            }
+            return *this;
+        }
+        future(const future &) = delete;
+        future &operator=(const future &) = delete;
+        ~future() { reset(); }
+
+        [[nodiscard]] bool valid() const noexcept { return state_ != nullptr; }
+
+        /**
+         * @brief Whether the result is available, i.e. get() will not block.
+         */
+        [[nodiscard]] bool is_ready() const { return state_ != nullptr && state_->is_ready(); }
+
+        /**
+         * @brief Block until the result is available. On a worker thread of a dp::thread_pool,
+         * pending tasks of that pool are run until then instead.
+         */
+        void wait() const {
+            check_valid();
+            state_->wait();
+        }
+
+        /**
+         * @brief Block until the result is available and return it, rethrowing any stored
+         * exception. The future is no longer valid afterwards.
+         */
+        T get() {
+            check_valid();
+            // release the state even if get() throws
+            auto *state = std::exchange(state_, nullptr);
+            struct release_guard {
+                details::shared_state<T> *state;
+                ~release_guard() { state->release(); }
+            } guard{state};
+            return state->get();
+        }
+
+        /**
+         * @brief Run @p func on @p executor once the result is available, without blocking any
+         * thread. The future is no longer valid afterwards.
+         * @details @p func is called with the result (without arguments for `future<void>`) or,
+         * if it can't take the result, with the ready future itself. In the former case a stored
+         * exception is passed on to the returned future without calling @p func. When the result
+         * is set by a task of a dp::thread_pool, the continuation is pushed to the queue of the
+         * worker that ran that task. The continuation is not subject to the overflow policy of a
+         * bounded pool, see dp::thread_pool::enqueue_continuation().
+         * @param executor Anything with an `enqueue_detach(function)` member, like
+         * dp::thread_pool. It must outlive this future.
+         * @return A future for the result of @p func.
+         */
+        template <typename Executor, typename Function>
+        auto then(Executor &executor, Function &&func) {
+            using function_type = std::decay_t<Function>;
+            using result_type = decltype(details::invoke_continuation(
+                std::declval<function_type &>(), std::declval<future &>()));
+            check_valid();
+
+            auto *state = state_;
+            auto *resource = state->resource();
+            promise<result_type> next(resource);
+            auto result = next.get_future();
+
+            // shared, so that the task is copyable for std::function and the promise is broken
+            // if the task is dropped (e.g. by clear_tasks())
+            struct job {
+                job(Function &&f, future &&antecedent_future, promise<result_type> &&promise)
+                    : function(std::forward<Function>(f)),
+                      antecedent(std::move(antecedent_future)),
+                      next(std::move(promise)) {}
+
+                function_type function;
+                future antecedent;
+                promise<result_type> next;
+            };
+            auto shared = std::allocate_shared<job>(std::pmr::polymorphic_allocator<>(resource),
+                                                    std::forward<Function>(func), std::move(*this),
+                                                    std::move(next));
+            state->set_continuation([&executor, shared] {
+                try {
+                    details::enqueue_continuation(executor, [shared] {
+                        details::fulfill(shared->next, [&shared]() -> decltype(auto) {
+                            return details::invoke_continuation(shared->function,
+                                                                shared->antecedent);
+                        });
+                    });
+                } catch (...) {
+                    shared->next.set_exception(std::current_exception());
+                }
+            });
+            return result;
+        }
+
+      private:
+        friend class promise<T>;
+        friend struct details::future_access;
+        explicit future(details::shared_state<T> *state) : state_(state) {}
+
+        void check_valid() const {
+            if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        }
+
+        void reset() {
+            if (state_ != nullptr) std::exchange(state_, nullptr)->release();
+        }
+
+        details::shared_state<T> *state_{nullptr};
+    };
+
+    /**
+     * @brief Lightweight alternative to std::promise, see dp::future.
+     * @details Copies of a promise refer to the same shared state, which allows it to be stored in
+     * copyable function wrappers like std::function. The promise is broken (a std::future_error
+     * is stored) when the last copy is destroyed without a result being set.
+     */
+    template <typename T>
+    class promise {
+      public:
+        promise() : promise(std::pmr::get_default_resource()) {}
+
+        /**
+         * @brief Construct a promise whose shared state is allocated from @p resource.
+         */
+        explicit promise(std::pmr::memory_resource *resource)
+            : state_(details::shared_state<T>::create(resource)) {}
+
+        promise(const promise &other) : state_(other.state_) {
+            if (state_ != nullptr) {
+                state_->add_reference();
+                state_->add_promise();
+            }
+        }
+        promise(promise &&other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+        promise &operator=(promise other) noexcept {
+            std::swap(state_, other.state_);
+            return *this;
+        }
+        ~promise() {
+            if (state_ != nullptr) state_->release_promise();
+        }
+
+        /**
+         * @brief Get the future tied to this promise. Can only be called once.
+         */
+        [[nodiscard]] future<T> get_future() {
+            check_valid();
+            state_->retrieve_future();
+            return future<T>(state_);
+        }
+
+        template <typename... Args>
+        void set_value(Args &&...args) {
+            check_valid();
+            state_->set_value(std::forward<Args>(args)...);
+        }
+
+        void set_exception(std::exception_ptr exception) {
+            check_valid();
+            state_->set_exception(std::move(exception));
+        }
+
+      private:
+        void check_valid() const {
+            if (state_ == nullptr) throw std::future_error(std::future_errc::no_state);
+        }
+
+        details::shared_state<T> *state_;
+    };
+
+    namespace details {
+        struct future_access {
+            template <typename T>
+            static shared_state<T> *state(const future<T> &value) {
+                value.check_valid();
+                return value.state_;
+            }
+        };
+
+        /**
+         * @brief Completes the future returned by dp::when_all() once the last of the futures is
+         * ready.
+         */
+        template <typename Futures>
+        struct when_all_state {
+            when_all_state(std::pmr::memory_resource *memory, Futures all, std::size_t count)
+                : resource(memory), futures(std::move(all)), remaining(count), result(memory) {}
+
+            void complete_one() {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                auto done = std::move(result);
+                auto ready = std::move(futures);
+                std::pmr::polymorphic_allocator<>(resource).delete_object(this);
+                done.set_value(std::move(ready));
+            }
+
+            std::pmr::memory_resource *resource;
+            Futures futures;
+            std::atomic_size_t remaining;
+            promise<Futures> result;
+        };
+
+        /**
+         * @brief Completes the future returned by dp::when_any() once the first of the futures
+         * is ready, freed once all of them are.
+         */
+        template <typename Result, typename Futures>
+        struct when_any_state {
+            when_any_state(std::pmr::memory_resource *memory, Futures all, std::size_t count)
+                : resource(memory),
+                  futures(std::move(all)),
+                  references(count + 1),
+                  result(memory) {}
+
+            void complete(std::size_t index) {
+                if (!done.test_and_set(std::memory_order_acq_rel)) {
+                    result.set_value(Result{index, std::move(futures)});
+                }
+                release();
+            }
+
+            void release() {
+                if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::pmr::polymorphic_allocator<>(resource).delete_object(this);
+                }
+            }
+
+            std::pmr::memory_resource *resource;
+            Futures futures;
+            std::atomic_size_t references;
+            std::atomic_flag done{};
+            promise<Result> result;
+        };
+    }  // namespace details
+
+    /**
+     * @brief A future that becomes ready once all of @p futures are, holding them.
+     * @details No thread blocks: the future that becomes ready last completes the returned one on
+     * the thread that set its result. Use future::then() on the result to run a task afterwards.
+     */
+    template <typename T>
+    future<std::vector<future<T>>> when_all(std::vector<future<T>> futures) {
+        using futures_type = std::vector<future<T>>;
+        if (futures.empty()) {
+            promise<futures_type> ready;
+            ready.set_value();
+            return ready.get_future();
+        }
+
+        auto *resource = details::future_access::state(futures.front())->resource();
+        std::vector<details::shared_state<T> *> states;
+        states.reserve(futures.size());
+        for (const auto &value : futures) states.push_back(details::future_access::state(value));
+
+        auto *all = std::pmr::polymorphic_allocator<>(resource)
+                        .new_object<details::when_all_state<futures_type>>(
+                            resource, std::move(futures), states.size());
+        auto result = all->result.get_future();
+        // all is freed by the last continuation, so it can't be used in this loop
+        for (auto *state : states) state->set_continuation([all] { all->complete_one(); });
+        return result;
+    }
+
+    /**
+     * @brief A future that becomes ready once all of @p futures are, holding them. See
+     * when_all(std::vector<future<T>>).
+     */
+    template <typename... T>
+        requires(sizeof...(T) > 0)
+    future<std::tuple<future<T>...>> when_all(future<T>... futures) {
+        using futures_type = std::tuple<future<T>...>;
+        const auto states = std::tuple{details::future_access::state(futures)...};
+        auto *resource = std::get<0>(states)->resource();
+
+        auto *all = std::pmr::polymorphic_allocator<>(resource)
+                        .new_object<details::when_all_state<futures_type>>(
+                            resource, futures_type{std::move(futures)...}, sizeof...(T));
+        auto result = all->result.get_future();
+        std::apply(
+            [all](auto *...state) {
+                (state->set_continuation([all] { all->complete_one(); }), ...);
+            },
+            states);
+        return result;
+    }
+
+    /**
+     * @brief The result of dp::when_any(): the index of the first ready future and all futures.
+     */
+    template <typename T>
+    struct when_any_result {
+        std::size_t index;
+        std::vector<future<T>> futures;
+    };
+
+    /**
+     * @brief A future that becomes ready once any of @p futures is, holding all of them and the
+     * index of the ready one. Like dp::when_all(), this never blocks a thread.
+     * @details If @p futures is empty the result is ready right away with an index of
+     * `static_cast<std::size_t>(-1)`.
+     */
+    template <typename T>
+    future<when_any_result<T>> when_any(std::vector<future<T>> futures) {
+        using result_type = when_any_result<T>;
+        if (futures.empty()) {
+            promise<result_type> ready;
+            ready.set_value(result_type{static_cast<std::size_t>(-1), {}});
+            return ready.get_future();
+        }
+
+        auto *resource = details::future_access::state(futures.front())->resource();
+        std::vector<details::shared_state<T> *> states;
+        states.reserve(futures.size());
+        for (const auto &value : futures) states.push_back(details::future_access::state(value));
+        // the futures are handed out by the first continuation, keep their states alive until
+        // all continuations are attached
+        for (auto *state : states) state->add_reference();
+
+        using any_type = details::when_any_state<result_type, std::vector<future<T>>>;
+        auto *any = std::pmr::polymorphic_allocator<>(resource).new_object<any_type>(
+            resource, std::move(futures), states.size());
+        auto result = any->result.get_future();
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            states[i]->set_continuation([any, i] { any->complete(i); });
+        }
+        any->release();
+        for (auto *state : states) state->release();
+        return result;
+    }
+}  // namespace dp
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tuple>
+
+#include "cache_line.h"
+
+namespace dp::details {
+    /**
+     * @brief Lock free set of idle workers, stored as an atomic bitmap.
+     * @details Workers mark themselves idle before they go to sleep. Producers claim an idle worker
+     * (clearing its bit) and are then responsible for waking it up. When no worker is idle, workers
+     * are handed out in round-robin order.
+     */
+    class idle_worker_tracker {
+        using word_type = std::uint64_t;
+        static constexpr std::size_t bits_per_word = sizeof(word_type) * 8;
+
+      public:
+        explicit idle_worker_tracker(std::size_t capacity)
+            : word_count_((capacity + bits_per_word - 1) / bits_per_word),
+              words_(std::make_unique<std::atomic<word_type>[]>(word_count_)) {}
+
+        /**
+         * @brief Add a worker to the set of workers that can be handed out.
+         * @details Worker ids must be added in order, starting from 0. The worker starts idle.
+         */
+        void add_worker(std::size_t id) {
+            mark_idle(id);
+            size_.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Remove the worker that was added last, it is no longer handed out.
+         * @details The worker may still be claimed by a producer that raced with the removal, it
+         * has to clear its own bit once more before it exits.
+         */
+        void remove_worker(std::size_t id) {
+            size_.fetch_sub(1, std::memory_order_release);
+            std::ignore = try_claim(id);
+        }
+
+        [[nodiscard]] std::size_t size() const { return size_.load(std::memory_order_acquire); }
+
+        void mark_idle(std::size_t id) {
+            words_[id / bits_per_word].fetch_or(mask(id), std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief Claim a specific worker.
+         * @return true if the worker was idle and has now been claimed by the caller.
+         */
+        bool try_claim(std::size_t id) {
+            const auto bit = mask(id);
+            return (words_[id / bits_per_word].fetch_and(~bit, std::memory_order_seq_cst) & bit) !=
+                   0;
+        }
+
+        /**
+         * @brief Claim any idle worker.
+         * @return The id of the claimed worker or std::nullopt if all workers are busy.
+         */
+        [[nodiscard]] std::optional<std::size_t> try_claim_any() {
+            for (std::size_t w = 0; w < word_count_; ++w) {
+                auto bits = words_[w].load(std::memory_order_seq_cst);
+                while (bits != 0) {
+                    const auto bit = static_cast<std::size_t>(std::countr_zero(bits));
+                    if (words_[w].compare_exchange_weak(bits, bits & ~mask(bit),
+                                                        std::memory_order_seq_cst)) {
+                        return w * bits_per_word + bit;
+                    }
+                }
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Next worker in round-robin order, regardless of whether it is idle.
+         */
+        [[nodiscard]] std::size_t next() {
+            return next_.fetch_add(1, std::memory_order_relaxed) % size();
+        }
+
+      private:
+        static word_type mask(std::size_t id) { return word_type{1} << (id % bits_per_word); }
+
+        std::size_t word_count_;
+        std::unique_ptr<std::atomic<word_type>[]> words_;
+        std::atomic_size_t size_{0};
+        // incremented by every producer when all workers are busy
+        alignas(cache_line_size) std::atomic_size_t next_{0};
+    };
+}  // namespace dp::details
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dp {
+    template <typename Signature, std::size_t Capacity = 64,
+              std::size_t Alignment = alignof(std::max_align_t)>
+    class inplace_function;
+
+    /**
+     * @brief Move-only function wrapper that always stores the callable inline.
+     * @details Unlike std::function and std::move_only_function, this never allocates. Callables
+     * that do not fit in @p Capacity bytes (or require a stricter alignment than @p Alignment) are
+     * rejected at compile time. Use @ref fits to check this ahead of time, for example to select a
+     * different function type.
+     *
+     * Can be used as the `FunctionType` of dp::thread_pool, e.g.
+     * `dp::thread_pool<dp::inplace_function<void()>>`.
+     * @tparam R The return type.
+     * @tparam Args The argument types.
+     * @tparam Capacity The size, in bytes, of the inline storage.
+     * @tparam Alignment The alignment of the inline storage.
+     */
+    template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment>
+    class inplace_function<R(Args...), Capacity, Alignment> {
+      public:
+        /**
+         * @brief Whether a callable of type @p F can be stored inline.
+         */
+        template <typename F>
+        static constexpr bool fits = sizeof(F) <= Capacity && alignof(F) <= Alignment;
+
+        inplace_function() noexcept = default;
+
+        template <typename F, typename Function = std::decay_t<F>>
+            requires(!std::is_same_v<Function, inplace_function>) &&
+                    std::is_invocable_r_v<R, Function &, Args...> &&
+                    std::is_move_constructible_v<Function>
+        inplace_function(F &&function) {  // NOLINT(google-explicit-constructor)
+            static_assert(fits<Function>,
+                          "Callable does not fit in the inline storage of dp::inplace_function. "
+                          "Increase the Capacity or reduce the size of the captures.");
+            ::new (static_cast<void *>(&storage_)) Function(std::forward<F>(function));
+            vtable_ = &vtable_for<Function>;
+        }
+
+        inplace_function(inplace_function &&other) { move_from(other); }
+
+        inplace_function &operator=(inplace_function &&other) {
+            if (this != std::addressof(other)) {
+                reset();
+                move_from(other);
+            }
+            return *this;
+        }
+
+        inplace_function(const inplace_function &) = delete;
+        inplace_function &operator=(const inplace_function &) = delete;
+
+        ~inplace_function() { reset(); }
+
+        R operator()(Args... args) {
+            if (vtable_ == nullptr) throw std::bad_function_call();
+            return vtable_->invoke(&storage_, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+      private:
+        struct vtable {
+            R (*invoke)(void *, Args &&...);
+            void (*move)(void *destination, void *source);
+            void (*destroy)(void *);
+        };
+
+        template <typename Function>
+        static constexpr vtable vtable_for{
+            [](void *storage, Args &&...args) -> R {
+                if constexpr (std::is_void_v<R>) {
+                    std::invoke(*static_cast<Function *>(storage), std::forward<Args>(args)...);
+                } else {
+                    return std::invoke(*static_cast<Function *>(storage),
+                                       std::forward<Args>(args)...);
+                }
+            },
+            [](void *destination, void *source) {
+                ::new (destination) Function(std::move(*static_cast<Function *>(source)));
+            },
+            [](void *storage) { static_cast<Function *>(storage)->~Function(); }};
+
+        void move_from(inplace_function &other) {
+            if (other.vtable_ == nullptr) return;
+            other.vtable_->move(&storage_, &other.storage_);
+            vtable_ = std::exchange(other.vtable_, nullptr);
+            vtable_->destroy(&other.storage_);
+        }
+
+        void reset() {
+            if (vtable_ != nullptr) std::exchange(vtable_, nullptr)->destroy(&storage_);
+        }
+
+        alignas(Alignment) std::byte storage_[Capacity];
+        const vtable *vtable_{nullptr};
+    };
+}  // namespace dp
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "drop_guard.h"
+#include "worker_context.h"
+
+namespace dp {
+    namespace details {
+        /**
+         * @brief Shared state of a single parallel_for call.
+         * @details Shared between all the tasks of the call so that it outlives the last task,
+         * even if the caller is woken up before that task has returned.
+         */
+        template <typename Index, typename Body>
+        class parallel_for_state {
+          public:
+            parallel_for_state(std::size_t count, Body &body) : remaining_(count), body_(body) {}
+
+            void run(Index first, Index last) {
+                try {
+                    for (auto i = first; i != last; ++i) std::invoke(body_, i);
+                } catch (...) {
+                    set_exception(std::current_exception());
+                }
+
+                complete(static_cast<std::size_t>(last - first));
+            }
+
+            /**
+             * @brief The task for [first, last) was dropped without running.
+             */
+            void abandon(Index first, Index last) {
+                set_exception(
+                    std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+                complete(static_cast<std::size_t>(last - first));
+            }
+
+            /**
+             * @brief Block until every index has been processed and rethrow the first exception
+             * thrown by the body (if any).
+             * @details Called from a worker thread, the worker runs pending tasks (including the
+             * chunks of this call) in the meantime, so nested loops don't deadlock the pool.
+             */
+            void wait() {
+                if (!help_while_waiting([this] {
+                        return remaining_.load(std::memory_order_acquire) == 0;
+                    })) {
+                    // must be a loop to ignore spurious wake-ups
+                    for (auto remaining = remaining_.load(std::memory_order_acquire);
+                         remaining != 0; remaining = remaining_.load(std::memory_order_acquire)) {
+                        remaining_.wait(remaining, std::memory_order_acquire);
+                    }
+                }
+
+                if (exception_) std::rethrow_exception(exception_);
+            }
+
+          private:
+            void set_exception(std::exception_ptr exception) {
+                std::scoped_lock lock(exception_mutex_);
+                if (!exception_) exception_ = std::move(exception);
+            }
+
+            void complete(std::size_t count) {
+                if (remaining_.fetch_sub(count, std::memory_order_seq_cst) == count) {
+                    remaining_.notify_all();
+                    notify_waiting_workers();
+                }
+            }
+
+            std::atomic_size_t remaining_;
+            Body &body_;
+            std::mutex exception_mutex_;
+            std::exception_ptr exception_;
+        };
+
+        /**
+         * @brief Recursively split off the upper half of the range as a new task until the
+         * remaining range is no larger than the grain size, then process it on this thread.
+         * @details Tasks enqueued from a worker go to that worker's own queue, so idle workers pick
+         * up the large upper halves by stealing.
+         */
+        template <typename Pool, typename Index, typename State>
+        void parallel_for_split(Pool &pool, Index first, Index last, std::size_t grain,
+                                const std::shared_ptr<State> &state) {
+            while (static_cast<std::size_t>(last - first) > grain) {
+                const auto middle = first + (last - first) / 2;
+                // if the task is dropped without running, the caller must not wait for it forever
+                auto guard = drop_guard([state, middle, last] { state->abandon(middle, last); });
+                enqueue_continuation(
+                    pool, [&pool, middle, last, grain, state, guard = std::move(guard)]() mutable {
+                        guard.dismiss();
+                        parallel_for_split(pool, middle, last, grain, state);
+                    });
+                last = middle;
+            }
+            state->run(first, last);
+        }
+
+        template <typename Pool>
+        std::size_t default_grain_size(const Pool &pool, std::size_t count) {
+            // aim for a few chunks per worker so that stealing can balance the load
+            constexpr std::size_t chunks_per_worker = 8;
+            return std::max<std::size_t>(1, count / (pool.size() * chunks_per_worker));
+        }
+
+        /**
+         * @brief Combine the partial results in a balanced tree, preserving their order.
+         */
+        template <typename T, typename BinaryOp>
+        T tree_reduce(std::vector<std::optional<T>> &partials, BinaryOp &reduce) {
+            for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+                for (std::size_t i = 0; i + stride < partials.size(); i += 2 * stride) {
+                    partials[i] = std::invoke(reduce, std::move(*partials[i]),
+                                              std::move(*partials[i + stride]));
+                }
+            }
+            return std::move(*partials.front());
+        }
+    }  // namespace details
+
+    /**
+     * @brief Invoke @p body for every index in [first, last) using the given thread pool.
+     * @details The range is split recursively into chunks of at most @p grain indices which are
+     * processed by the workers of the pool. This function blocks until all indices have been
+     * processed. If the body throws, the first exception is rethrown once all chunks are done.
+     * Chunks that are dropped by the pool without running (see dp::thread_pool::clear_tasks())
+     * are reported as std::future_error with std::future_errc::broken_promise.
+     * @param pool The thread pool to use.
+     * @param first The first index.
+     * @param last One past the last index.
+     * @param body Callable that is invoked with each index.
+     * @param grain Maximum number of indices processed by a single task. If 0, a grain size is
+     * chosen based on the size of the range and the number of threads in the pool.
+     */
+    template <typename Pool, std::integral Index, typename Body>
+        requires std::invocable<Body &, Index>
+    void parallel_for(Pool &pool, Index first, Index last, Body &&body, std::size_t grain = 0) {
+        if (last <= first) return;
+
+        const auto count = static_cast<std::size_t>(last - first);
+        if (pool.size() == 0) {
+            // nothing to run on, so process the range on the calling thread
+            for (auto i = first; i != last; ++i) std::invoke(body, i);
+            return;
+        }
+        if (grain == 0) grain = details::default_grain_size(pool, count);
+
+        auto state =
+            std::make_shared<details::parallel_for_state<Index, std::remove_reference_t<Body>>>(
+                count, body);
+        details::parallel_for_split(pool, first, last, grain, state);
+        state->wait();
+    }
+
+    /**
+     * @brief Invoke @p body for every element in [first, last) using the given thread pool.
+     * @details See @ref parallel_for() for details.
+     */
+    template <typename Pool, std::random_access_iterator Iterator, typename Body>
+        requires std::invocable<Body &, std::iter_reference_t<Iterator>>
+    void parallel_for_each(Pool &pool, Iterator first, Iterator last, Body &&body,
+                           std::size_t grain = 0) {
+        parallel_for(
+            pool, std::iter_difference_t<Iterator>{0}, last - first,
+            [&body, first](std::iter_difference_t<Iterator> i) { std::invoke(body, first[i]); },
+            grain);
+    }
+
+    /**
+     * @brief Invoke @p body for every element in @p range using the given thread pool.
+     * @details See @ref parallel_for() for details.
+     */
+    template <typename Pool, std::ranges::random_access_range Range, typename Body>
+        requires std::invocable<Body &, std::ranges::range_reference_t<Range>>
+    void parallel_for_each(Pool &pool, Range &&range, Body &&body, std::size_t grain = 0) {
+        const auto first = std::ranges::begin(range);
+        parallel_for_each(pool, first, first + std::ranges::distance(range),
+                          std::forward<Body>(body), grain);
+    }
+
+    /**
+     * @brief Transform every element in [first, last) and reduce the results using the given
+     * thread pool.
+     * @details The range is split into chunks of at most @p grain elements. Every chunk is reduced
+     * in order into its own partial result, so workers never share an accumulator, and the
+     * partial results are then combined in a tree. The chunks only depend on the size of the range
+     * and @p grain, so the result is deterministic as long as @p reduce is associative; it does
+     * not need to be commutative. The result is `reduce(init, transform(*first) ... )`.
+     * @param pool The thread pool to use.
+     * @param first The first element.
+     * @param last One past the last element.
+     * @param init The initial value, combined with the reduced range as the left-most operand.
+     * @param reduce Associative binary operation.
+     * @param transform Unary operation applied to each element.
+     * @param grain Maximum number of elements reduced by a single task. If 0, a grain size is
+     * chosen based on the size of the range and the number of threads in the pool.
+     */
+    template <typename Pool, std::random_access_iterator Iterator, typename T, typename BinaryOp,
+              typename UnaryOp>
+        requires std::invocable<UnaryOp &, std::iter_reference_t<Iterator>> &&
+                 std::invocable<BinaryOp &, T, T>
+    T parallel_transform_reduce(Pool &pool, Iterator first, Iterator last, T init,
+                                BinaryOp reduce, UnaryOp transform, std::size_t grain = 0) {
+        if (last <= first) return init;
+
+        const auto count = static_cast<std::size_t>(last - first);
+        if (grain == 0) {
+            grain = pool.size() == 0 ? count : details::default_grain_size(pool, count);
+        }
+
+        const auto chunk_count = (count + grain - 1) / grain;
+        std::vector<std::optional<T>> partials(chunk_count);
+        parallel_for(
+            pool, std::size_t{0}, chunk_count,
+            [&](std::size_t chunk) {
+                const auto chunk_first = first + static_cast<std::ptrdiff_t>(chunk * grain);
+                const auto chunk_last =
+                    first + static_cast<std::ptrdiff_t>(std::min(count, (chunk + 1) * grain));
+
+                T partial(std::invoke(transform, *chunk_first));
+                for (auto it = chunk_first + 1; it != chunk_last; ++it) {
+                    partial = std::invoke(reduce, std::move(partial), std::invoke(transform, *it));
+                }
+                partials[chunk] = std::move(partial);
+            },
+            1);
+
+        return std::invoke(reduce, std::move(init), details::tree_reduce(partials, reduce));
+    }
+
+    /**
+     * @brief Transform every element in @p range and reduce the results using the given thread
+     * pool.
+     * @details See @ref parallel_transform_reduce() for details.
+     */
+    template <typename Pool, std::ranges::random_access_range Range, typename T,
+              typename BinaryOp, typename UnaryOp>
+        requires std::invocable<UnaryOp &, std::ranges::range_reference_t<Range>> &&
+                 std::invocable<BinaryOp &, T, T>
+    T parallel_transform_reduce(Pool &pool, Range &&range, T init, BinaryOp reduce,
+                                UnaryOp transform, std::size_t grain = 0) {
+        const auto first = std::ranges::begin(range);
+        return parallel_transform_reduce(pool, first, first + std::ranges::distance(range),
+                                         std::move(init), std::move(reduce), std::move(transform),
+                                         grain);
+    }
+
+    /**
+     * @brief Reduce every element in [first, last) using the given thread pool.
+     * @details See @ref parallel_transform_reduce() for details.
+     */
+    template <typename Pool, std::random_access_iterator Iterator, typename T,
+              typename BinaryOp = std::plus<>>
+        requires std::invocable<BinaryOp &, T, T>
+    T parallel_reduce(Pool &pool, Iterator first, Iterator last, T init,
+                      BinaryOp reduce = BinaryOp{}, std::size_t grain = 0) {
+        return parallel_transform_reduce(pool, first, last, std::move(init), std::move(reduce),
+                                         std::identity{}, grain);
+    }
+
+    /**
+     * @brief Reduce every element in @p range using the given thread pool.
+     * @details See @ref parallel_transform_reduce() for details.
+     */
+    template <typename Pool, std::ranges::random_access_range Range, typename T,
+              typename BinaryOp = std::plus<>>
+        requires std::invocable<BinaryOp &, T, T>
+    T parallel_reduce(Pool &pool, Range &&range, T init, BinaryOp reduce = BinaryOp{},
+                      std::size_t grain = 0) {
+        const auto first = std::ranges::begin(range);
+        return parallel_reduce(pool, first, first + std::ranges::distance(range),
+                               std::move(init), std::move(reduce), grain);
+    }
+}  // namespace dp
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dp {
+    namespace details {
+        /**
+         * @brief The cache of a recycling_memory_resource used last by the current thread, keyed
+         * by the unique id of the resource.
+         */
+        struct recycling_cache_entry {
+            std::uint64_t resource_id{0};
+            void *instance{nullptr};
+        };
+
+        inline thread_local recycling_cache_entry last_recycling_cache{};
+
+        /**
+         * @brief Whether a cache of a recycling_memory_resource belongs to a running thread.
+         * @details Shared by the cache and the thread, so that neither has to outlive the other.
+         */
+        struct recycling_cache_lease {
+            std::atomic_bool in_use{false};
+        };
+
+        /**
+         * @brief The leases of the caches used by the current thread, released when it exits so
+         * that new threads can take over the caches.
+         */
+        class recycling_cache_leases {
+          public:
+            recycling_cache_leases() = default;
+            recycling_cache_leases(const recycling_cache_leases &) = delete;
+            recycling_cache_leases &operator=(const recycling_cache_leases &) = delete;
+
+            ~recycling_cache_leases() {
+                for (const auto &lease : leases_) {
+                    lease->in_use.store(false, std::memory_order_release);
+                }
+            }
+
+            void add(std::shared_ptr<recycling_cache_lease> lease) {
+                // forget the caches of resources that were destroyed
+                std::erase_if(leases_, [](const auto &held) { return held.use_count() == 1; });
+                leases_.push_back(std::move(lease));
+            }
+
+          private:
+            std::vector<std::shared_ptr<recycling_cache_lease>> leases_;
+        };
+
+        inline thread_local recycling_cache_leases current_recycling_leases{};
+    }  // namespace details
+
+    /**
+     * @brief Memory resource that recycles small blocks through per-thread caches.
+     * @details Every thread that allocates from the resource gets its own cache with a free list
+     * per size class, so allocating and deallocating on the same thread never synchronizes.
+     * Blocks deallocated by another thread are pushed onto a lock-free list of the cache that
+     * allocated them and are reclaimed by that cache once its own free list runs dry. With the
+     * producer/worker pattern of dp::thread_pool (tasks allocated by the producer, released by a
+     * worker) this means that, once warmed up, the upstream resource is no longer used.
+     *
+     * Blocks larger than @ref max_block_size or with an alignment stricter than
+     * `alignof(std::max_align_t)` are forwarded to the upstream resource. Recycled memory is only
+     * returned to the upstream resource when this resource is destroyed, so it must outlive
+     * everything that allocates from it (including the thread pool that uses it). When a thread
+     * exits, its cache (with the blocks in it) is taken over by the next thread that allocates,
+     * so the number of caches is bounded by the number of threads that allocate at the same time,
+     * not by the number of threads that ever did, e.g. when workers are added and retired.
+     */
+    class recycling_memory_resource : public std::pmr::memory_resource {
+      public:
+        static constexpr std::size_t max_block_size = 1024;
+
+        explicit recycling_memory_resource(
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : upstream_(upstream) {}
+
+        /// resource is non-copyable
+        recycling_memory_resource(const recycling_memory_resource &) = delete;
+        recycling_memory_resource &operator=(const recycling_memory_resource &) = delete;
+
+        ~recycling_memory_resource() override = default;
+
+        [[nodiscard]] std::pmr::memory_resource *upstream_resource() const { return upstream_; }
+
+      protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (!is_recycled(bytes, alignment)) return upstream_->allocate(bytes, alignment);
+
+            const auto size_class = size_class_of(bytes);
+            auto &cache = local_cache();
+            auto *block = cache.free[size_class];
+            if (block == nullptr) {
+                // reclaim everything that other threads gave back to us
+                block = cache.remote_free[size_class].exchange(nullptr, std::memory_order_acquire);
+            }
+
+            if (block != nullptr) {
+                cache.free[size_class] = block->next;
+            } else {
+                block = static_cast<free_block *>(
+                    cache.arena.allocate(header_size + block_size(size_class), header_size));
+            }
+
+            auto *header = ::new (static_cast<void *>(block)) block_header{&cache};
+            return reinterpret_cast<std::byte *>(header) + header_size;
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+            if (!is_recycled(bytes, alignment)) {
+                upstream_->deallocate(pointer, bytes, alignment);
+                return;
+            }
+
+            const auto size_class = size_class_of(bytes);
+            auto *header = reinterpret_cast<block_header *>(static_cast<std::byte *>(pointer) -
+                                                            header_size);
+            auto *owner = header->owner;
+            auto *block = ::new (static_cast<void *>(header)) free_block{nullptr};
+
+            const auto &last_cache = details::last_recycling_cache;
+            if (last_cache.resource_id == id_ && last_cache.instance == owner) {
+                block->next = owner->free[size_class];
+                owner->free[size_class] = block;
+                return;
+            }
+
+            // hand the block back to the thread that allocated it
+            auto &remote = owner->remote_free[size_class];
+            block->next = remote.load(std::memory_order_relaxed);
+            while (!remote.compare_exchange_weak(block->next, block, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+            }
+        }
+
+        [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+
+      private:
+        static constexpr std::size_t min_block_size = 16;
+        static constexpr std::size_t size_class_count =
+            std::bit_width(max_block_size) - std::bit_width(min_block_size) + 1;
+        // keeps the returned memory aligned to alignof(std::max_align_t)
+        static constexpr std::size_t header_size = alignof(std::max_align_t);
+
+        struct free_block {
+            free_block *next;
+        };
+
+        struct cache;
+
+        struct block_header {
+            cache *owner;
+        };
+
+        struct cache {
+            explicit cache(std::pmr::memory_resource *upstream) : arena(upstream) {}
+
+            // guarded by caches_mutex_, only meaningful while the lease is in use
+            std::thread::id owner{};
+            std::shared_ptr<details::recycling_cache_lease> lease{
+                std::make_shared<details::recycling_cache_lease>()};
+            // only accessed by the owning thread
+            std::array<free_block *, size_class_count> free{};
+            // blocks deallocated by other threads
+            std::array<std::atomic<free_block *>, size_class_count> remote_free{};
+            std::pmr::monotonic_buffer_resource arena;
+        };
+
+        static bool is_recycled(std::size_t bytes, std::size_t alignment) {
+            return bytes <= max_block_size && alignment <= header_size;
+        }
+
+        static std::size_t size_class_of(std::size_t bytes) {
+            return static_cast<std::size_t>(
+                std::bit_width((std::max<std::size_t>(bytes, 1) - 1) | (min_block_size - 1)) -
+                std::bit_width(min_block_size - 1));
+        }
+
+        static constexpr std::size_t block_size(std::size_t size_class) {
+            return min_block_size << size_class;
+        }
+
+        cache &local_cache() {
+            auto &last_cache = details::last_recycling_cache;
+            if (last_cache.resource_id == id_) return *static_cast<cache *>(last_cache.instance);
+
+            std::scoped_lock lock(caches_mutex_);
+            const auto thread_id = std::this_thread::get_id();
+            const auto in_use = [](const std::unique_ptr<cache> &instance) {
+                return instance->lease->in_use.load(std::memory_order_acquire);
+            };
+            auto it = std::ranges::find_if(caches_, [&](const std::unique_ptr<cache> &instance) {
+                return instance->owner == thread_id && in_use(instance);
+            });
+            if (it == caches_.end()) {
+                // take over the cache of a thread that exited, or create a new one
+                it = std::ranges::find_if_not(caches_, in_use);
+                if (it == caches_.end()) {
+                    caches_.push_back(std::make_unique<cache>(upstream_));
+                    it = std::prev(caches_.end());
+                }
+                (*it)->owner = thread_id;
+                (*it)->lease->in_use.store(true, std::memory_order_relaxed);
+                details::current_recycling_leases.add((*it)->lease);
+            }
+
+            last_cache = {id_, it->get()};
+            return **it;
+        }
+
+        static inline std::atomic_uint64_t next_id_{1};
+
+        std::uint64_t id_{next_id_.fetch_add(1, std::memory_order_relaxed)};
+        std::pmr::memory_resource *upstream_;
+        std::mutex caches_mutex_;
+        std::vector<std::unique_ptr<cache>> caches_;
+    };
+}  // namespace dp
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.h"
+
+namespace dp {
+    /**
+     * @brief Histogram of durations with power of two buckets: bucket 0 counts durations below
+     * 1ns and bucket i those in [2^(i-1), 2^i) nanoseconds. The last bucket also counts anything
+     * longer.
+     */
+    struct latency_histogram {
+        static constexpr std::size_t bucket_count = 40;
+
+        std::array<std::uint64_t, bucket_count> buckets{};
+
+        static constexpr std::size_t bucket_of(std::chrono::nanoseconds duration) {
+            if (duration.count() <= 0) return 0;
+            return std::min<std::size_t>(
+                static_cast<std::size_t>(
+                    std::bit_width(static_cast<std::uint64_t>(duration.count()))),
+                bucket_count - 1);
+        }
+
+        /**
+         * @brief The number of recorded durations.
+         */
+        [[nodiscard]] std::uint64_t count() const {
+            std::uint64_t total = 0;
+            for (const auto bucket : buckets) total += bucket;
+            return total;
+        }
+
+        /**
+         * @brief Upper bound of the bucket that contains the given percentile, e.g. 0.99 for the
+         * 99th percentile. Zero if nothing was recorded.
+         */
+        [[nodiscard]] std::chrono::nanoseconds percentile(double fraction) const {
+            const auto total = count();
+            if (total == 0) return std::chrono::nanoseconds{0};
+            const auto rank = static_cast<std::uint64_t>(
+                std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total - 1));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < bucket_count; ++i) {
+                seen += buckets[i];
+                if (seen > rank) return std::chrono::nanoseconds{std::int64_t{1} << i};
+            }
+            return std::chrono::nanoseconds{std::int64_t{1} << (bucket_count - 1)};
+        }
+
+        latency_histogram &operator+=(const latency_histogram &other) {
+            for (std::size_t i = 0; i < bucket_count; ++i) buckets[i] += other.buckets[i];
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Counters of a single worker of a dp::thread_pool, see dp::thread_pool::stats().
+     */
+    struct worker_statistics {
+        /// tasks run by this worker, including stolen ones
+        std::uint64_t tasks_executed{0};
+        /// tasks this worker took from the queues of other workers, including the ones a batch
+        /// steal moved to its own queue
+        std::uint64_t tasks_stolen{0};
+        /// tasks other workers took from the queues of this worker
+        std::uint64_t stolen_from{0};
+        /// steal attempts that found no task
+        std::uint64_t failed_steals{0};
+        /// time spent waiting for work, including spinning and yielding, see dp::idle_strategy
+        std::chrono::nanoseconds parked_time{0};
+        /// time spent awake, running tasks or looking for them
+        std::chrono::nanoseconds busy_time{0};
+        /// tasks currently waiting in the queues of this worker
+        std::size_t queue_depth{0};
+        /// time from enqueue to start for a sample of the tasks started by this worker, not
+        /// including coroutine resumptions (see dp::thread_pool::schedule())
+        latency_histogram start_latency{};
+
+        worker_statistics &operator+=(const worker_statistics &other) {
+            tasks_executed += other.tasks_executed;
+            tasks_stolen += other.tasks_stolen;
+            stolen_from += other.stolen_from;
+            failed_steals += other.failed_steals;
+            parked_time += other.parked_time;
+            busy_time += other.busy_time;
+            queue_depth += other.queue_depth;
+            start_latency += other.start_latency;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Snapshot of the state of a dp::thread_pool, see dp::thread_pool::stats().
+     */
+    struct thread_pool_statistics {
+        /// one entry per worker that was ever started, indexed by worker id
+        std::vector<worker_statistics> workers{};
+        /// tasks that were enqueued, but not started yet
+        std::size_t queued_tasks{0};
+        /// tasks that were enqueued, but not completed yet
+        std::size_t in_flight_tasks{0};
+        /// delayed and periodic tasks that have not expired yet
+        std::size_t pending_timers{0};
+
+        /**
+         * @brief The counters of all workers added up.
+         */
+        [[nodiscard]] worker_statistics total() const {
+            worker_statistics sum;
+            for (const auto &worker : workers) sum += worker;
+            return sum;
+        }
+    };
+
+    namespace details {
+#ifdef TP_DISABLE_STATISTICS
+        inline constexpr bool collect_statistics = false;
+#else
+        /// whether workers keep the counters of dp::thread_pool::stats() up to date
+        inline constexpr bool collect_statistics = true;
+#endif
+
+        /// one in this many tasks enqueued by a thread has its start latency measured
+        inline constexpr std::uint32_t latency_sample_period = 64;
+
+        /**
+         * @brief Whether the task that is being enqueued by the calling thread should be sampled
+         * for the start latency histogram.
+         */
+        inline bool sample_start_latency() {
+            thread_local std::uint32_t countdown = 0;
+            if (countdown != 0) {
+                --countdown;
+                return false;
+            }
+            countdown = latency_sample_period - 1;
+            return true;
+        }
+
+        /**
+         * @brief The live counters behind dp::worker_statistics.
+         * @details All counters except stolen_from are only written by their worker, so they are
+         * updated with a relaxed load and store instead of a read-modify-write.
+         */
+        struct worker_counters {
+            using clock = std::chrono::steady_clock;
+
+            std::atomic_uint64_t tasks_stolen{0};
+            std::atomic_uint64_t failed_steals{0};
+            std::atomic_int64_t parked_ns{0};
+            std::atomic_int64_t busy_ns{0};
+            std::array<std::atomic_uint64_t, latency_histogram::bucket_count> start_latency{};
+            // written by the thieves
+            alignas(cache_line_size) std::atomic_uint64_t stolen_from{0};
+
+            template <typename T>
+            static void add(std::atomic<T> &counter, std::type_identity_t<T> value) {
+                counter.store(counter.load(std::memory_order_relaxed) + value,
+                              std::memory_order_relaxed);
+            }
+
+            void add_parked(clock::duration duration) {
+                add(parked_ns,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            }
+
+            void add_busy(clock::duration duration) {
+                add(busy_ns,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            }
+
+            void record_start_latency(clock::duration latency) {
+                const auto bucket = latency_histogram::bucket_of(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(latency));
+                add(start_latency[bucket], 1);
+            }
+
+            /**
+             * @brief Copy the counters into @p stats.
+             */
+            void read(worker_statistics &stats) const {
+                stats.tasks_stolen = tasks_stolen.load(std::memory_order_relaxed);
+                stats.stolen_from = stolen_from.load(std::memory_order_relaxed);
+                stats.failed_steals = failed_steals.load(std::memory_order_relaxed);
+                stats.parked_time =
+                    std::chrono::nanoseconds{parked_ns.load(std::memory_order_relaxed)};
+                stats.busy_time = std::chrono::nanoseconds{busy_ns.load(std::memory_order_relaxed)};
+                for (std::size_t i = 0; i < latency_histogram::bucket_count; ++i) {
+                    stats.start_latency.buckets[i] =
+                        start_latency[i].load(std::memory_order_relaxed);
+                }
+            }
+        };
+    }  // namespace details
+}  // namespace dp
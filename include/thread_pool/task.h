@@ -0,0 +1,229 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "future.h"
+
+namespace dp {
+    template <typename T = void>
+    class task;
+
+    namespace details {
+        template <typename T>
+        class task_promise_base {
+          public:
+            /**
+             * @brief Resumes the coroutine that awaited the task once it has completed.
+             */
+            struct final_awaiter {
+                [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(
+                    std::coroutine_handle<Promise> finished) const noexcept {
+                    // symmetric transfer, the continuation runs on this thread without growing
+                    // the stack
+                    return finished.promise().continuation_;
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            // tasks are lazy, they only start when awaited
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            final_awaiter final_suspend() const noexcept { return {}; }
+
+            void unhandled_exception() noexcept {
+                result_.template emplace<2>(std::current_exception());
+            }
+
+            void set_continuation(std::coroutine_handle<> continuation) noexcept {
+                continuation_ = continuation;
+            }
+
+            /**
+             * @brief The result of the completed task, rethrowing its exception if it threw.
+             */
+            T result() {
+                if (result_.index() == 2) std::rethrow_exception(std::get<2>(result_));
+                if constexpr (std::is_void_v<T>) {
+                    return;
+                } else if constexpr (std::is_reference_v<T>) {
+                    return std::get<1>(result_).get();
+                } else {
+                    return std::move(std::get<1>(result_));
+                }
+            }
+
+          protected:
+            using storage_type = std::conditional_t<
+                std::is_void_v<T>, std::monostate,
+                std::conditional_t<std::is_reference_v<T>,
+                                   std::reference_wrapper<std::remove_reference_t<T>>, T>>;
+
+            std::variant<std::monostate, storage_type, std::exception_ptr> result_{};
+
+          private:
+            std::coroutine_handle<> continuation_{std::noop_coroutine()};
+        };
+
+        template <typename T>
+        class task_promise : public task_promise_base<T> {
+          public:
+            task<T> get_return_object() noexcept;
+
+            template <typename Value = T>
+                requires std::convertible_to<Value &&, T>
+            void return_value(Value &&value) {
+                this->result_.template emplace<1>(std::forward<Value>(value));
+            }
+        };
+
+        template <>
+        class task_promise<void> : public task_promise_base<void> {
+          public:
+            task<void> get_return_object() noexcept;
+
+            void return_void() noexcept { result_.emplace<1>(); }
+        };
+
+        /**
+         * @brief A coroutine that starts right away and destroys itself when it completes.
+         */
+        struct detached_coroutine {
+            struct promise_type {
+                detached_coroutine get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+    }  // namespace details
+
+    /**
+     * @brief A lazily started coroutine that produces a value of type T.
+     * @details The coroutine only starts when the task is awaited, on the awaiting thread. Use
+     * dp::thread_pool::schedule() inside of it to continue on a worker. When the task completes,
+     * the awaiting coroutine is resumed on the same thread, i.e. on the worker that ran the end
+     * of the task:
+     * @code
+     * dp::task<int> compute(dp::thread_pool<> &pool) {
+     *     co_await pool.schedule();
+     *     co_return expensive();
+     * }
+     * dp::task<int> twice(dp::thread_pool<> &pool) { co_return co_await compute(pool) * 2; }
+     *
+     * int result = dp::sync_wait(twice(pool));
+     * @endcode
+     * Exceptions thrown by the coroutine are rethrown when the task is awaited.
+     */
+    template <typename T>
+    class [[nodiscard]] task {
+      public:
+        using promise_type = details::task_promise<T>;
+
+        task() noexcept = default;
+        task(task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+        task &operator=(task &&other) noexcept {
+            if (this != std::addressof(other)) {
+                reset();
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+        task(const task &) = delete;
+        task &operator=(const task &) = delete;
+        ~task() { reset(); }
+
+        /**
+         * @brief Whether the task refers to a coroutine.
+         */
+        [[nodiscard]] bool valid() const noexcept { return handle_ != nullptr; }
+
+        /**
+         * @brief Whether the coroutine has completed.
+         */
+        [[nodiscard]] bool is_ready() const noexcept { return !handle_ || handle_.done(); }
+
+        /**
+         * @brief Start the coroutine and suspend the awaiting one until it has completed. A task
+         * can only be awaited once.
+         */
+        auto operator co_await() && noexcept { return awaiter{handle_}; }
+        auto operator co_await() & noexcept { return awaiter{handle_}; }
+
+      private:
+        friend class details::task_promise<T>;
+        explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+        struct awaiter {
+            [[nodiscard]] bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().set_continuation(awaiting);
+                return handle;
+            }
+
+            T await_resume() {
+                if (!handle) throw std::future_error(std::future_errc::no_state);
+                return handle.promise().result();
+            }
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        void reset() noexcept {
+            if (handle_) std::exchange(handle_, nullptr).destroy();
+        }
+
+        std::coroutine_handle<promise_type> handle_{nullptr};
+    };
+
+    namespace details {
+        template <typename T>
+        task<T> task_promise<T>::get_return_object() noexcept {
+            return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+        }
+
+        inline task<void> task_promise<void>::get_return_object() noexcept {
+            return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+        }
+
+        template <typename T>
+        detached_coroutine complete_promise(task<T> work, promise<T> result) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await std::move(work);
+                    result.set_value();
+                } else {
+                    result.set_value(co_await std::move(work));
+                }
+            } catch (...) {
+                result.set_exception(std::current_exception());
+            }
+        }
+    }  // namespace details
+
+    /**
+     * @brief Run @p work and block until it has completed.
+     * @details Called from a worker of a dp::thread_pool, the worker runs pending tasks of its
+     * pool in the meantime, like when waiting on a dp::future.
+     * @return The result of the task, rethrowing its exception if it threw.
+     */
+    template <typename T>
+    T sync_wait(task<T> work) {
+        promise<T> result;
+        auto future = result.get_future();
+        details::complete_promise(std::move(work), std::move(result));
+        return future.get();
+    }
+}  // namespace dp
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "drop_guard.h"
+#include "future.h"
+#include "thread_pool.h"
+
+namespace dp {
+    /**
+     * @brief A reusable graph of tasks with dependencies between them.
+     * @details A task is enqueued as soon as all of its predecessors have completed, by the
+     * worker that completed the last of them, so it lands in that worker's own queue. No thread
+     * blocks in between:
+     * @code
+     * dp::task_graph graph;
+     * auto load = graph.emplace([] { load_input(); });
+     * auto left = graph.emplace([] { process_left(); });
+     * auto right = graph.emplace([] { process_right(); });
+     * auto merge = graph.emplace([] { merge_results(); });
+     * load.precede(left, right);
+     * merge.succeed(left, right);
+     * graph.run(pool).wait();
+     * @endcode
+     */
+    class task_graph {
+        struct node_state;
+
+      public:
+        /**
+         * @brief A handle to a task of a dp::task_graph, used to add dependencies. Only nodes of
+         * the same graph can be connected.
+         */
+        class node {
+          public:
+            /**
+             * @brief The given nodes run after this one.
+             */
+            template <std::same_as<node>... Nodes>
+            node &precede(Nodes... others) {
+                (add_edge(*state_, *others.state_), ...);
+                return *this;
+            }
+
+            /**
+             * @brief This node runs after the given ones.
+             */
+            template <std::same_as<node>... Nodes>
+            node &succeed(Nodes... others) {
+                (add_edge(*others.state_, *state_), ...);
+                return *this;
+            }
+
+          private:
+            friend class task_graph;
+            explicit node(node_state *state) : state_(state) {}
+
+            node_state *state_;
+        };
+
+        task_graph() = default;
+
+        /// graph is non-copyable
+        task_graph(const task_graph &) = delete;
+        task_graph &operator=(const task_graph &) = delete;
+
+        /**
+         * @brief Add a task to the graph. Any return value of the function will be ignored.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function on every run.
+         * @return The node of the task, to add dependencies to it.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function &, Args &...>
+        node emplace(Function &&func, Args &&...args) {
+            auto &state = nodes_.emplace_back();
+            state.work = [f = std::forward<Function>(func),
+                          ... largs = std::forward<Args>(args)]() mutable {
+                if constexpr (std::is_void_v<std::invoke_result_t<Function &, Args &...>>) {
+                    std::invoke(f, largs...);
+                } else {
+                    // the function returns a value, but it is ignored
+                    std::ignore = std::invoke(f, largs...);
+                }
+            };
+            return node(&state);
+        }
+
+        /**
+         * @brief The number of tasks in the graph.
+         */
+        [[nodiscard]] std::size_t size() const { return nodes_.size(); }
+
+        /**
+         * @brief Run every task of the graph once on @p pool, each one after all of its
+         * predecessors have completed.
+         * @details If a task throws, the tasks that haven't started yet are skipped and the first
+         * exception is stored in the returned future. The same happens with
+         * std::future_error(std::future_errc::broken_promise) if a task is dropped by the pool
+         * without running, see dp::thread_pool::clear_tasks(). The graph must not be modified,
+         * run again or destroyed before the returned future is ready.
+         * @param pool Anything with an `enqueue_detach(function)` member, like dp::thread_pool.
+         * @return A future that becomes ready once all tasks have completed.
+         * @throws std::invalid_argument if the dependencies form a cycle.
+         */
+        template <typename Pool>
+        dp::future<void> run(Pool &pool) {
+            const auto roots = start_nodes();
+
+            result_ = dp::promise<void>();
+            auto result = result_.get_future();
+            canceled_.store(false, std::memory_order_relaxed);
+            has_exception_.clear(std::memory_order_relaxed);
+            exception_ = nullptr;
+            remaining_.store(nodes_.size(), std::memory_order_relaxed);
+            if (nodes_.empty()) {
+                finish();
+                return result;
+            }
+
+            // the graph can complete (and be destroyed) before this loop ends, so it must only
+            // use the local list of roots
+            for (auto *root : roots) schedule(pool, *root);
+            return result;
+        }
+
+      private:
+        struct node_state {
+            details::default_function_type work{};
+            std::vector<node_state *> successors{};
+            // number of predecessors
+            std::size_t dependencies{0};
+            // number of predecessors that haven't completed yet in the current run
+            std::atomic_size_t remaining{0};
+        };
+
+        static void add_edge(node_state &from, node_state &to) {
+            from.successors.push_back(&to);
+            ++to.dependencies;
+        }
+
+        /**
+         * @brief Reset the dependency counts for a new run and find the nodes without
+         * predecessors.
+         * @throws std::invalid_argument if the graph has a cycle.
+         */
+        std::vector<node_state *> start_nodes() {
+            std::vector<node_state *> roots;
+            for (auto &state : nodes_) {
+                state.remaining.store(state.dependencies, std::memory_order_relaxed);
+                if (state.dependencies == 0) roots.push_back(&state);
+            }
+
+            // a topological sort visits every node unless there is a cycle
+            std::vector<node_state *> ready(roots);
+            std::size_t visited = 0;
+            while (!ready.empty()) {
+                auto *current = ready.back();
+                ready.pop_back();
+                ++visited;
+                for (auto *next : current->successors) {
+                    if (next->remaining.fetch_sub(1, std::memory_order_relaxed) == 1) {
+                        ready.push_back(next);
+                    }
+                }
+            }
+            if (visited != nodes_.size()) {
+                throw std::invalid_argument("dp::task_graph: the dependencies form a cycle");
+            }
+
+            for (auto &state : nodes_) {
+                state.remaining.store(state.dependencies, std::memory_order_relaxed);
+            }
+            return roots;
+        }
+
+        template <typename Pool>
+        void schedule(Pool &pool, node_state &state) {
+            // a node that is dropped without running fails the run, its successors are skipped
+            auto guard = details::drop_guard([this, &pool, &state] { abandon(pool, state); });
+            try {
+                details::enqueue_continuation(
+                    pool, [this, &pool, &state, guard = std::move(guard)]() mutable {
+                        guard.dismiss();
+                        execute(pool, state);
+                    });
+            } catch (...) {
+                // the guard has already failed the run
+            }
+        }
+
+        template <typename Pool>
+        void execute(Pool &pool, node_state &state) {
+            if (!canceled_.load(std::memory_order_relaxed)) {
+                try {
+                    std::invoke(state.work);
+                } catch (...) {
+                    // keep the first exception and skip the remaining tasks
+                    fail(std::current_exception());
+                }
+            }
+            complete(pool, state);
+        }
+
+        template <typename Pool>
+        void abandon(Pool &pool, node_state &state) {
+            fail(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            complete(pool, state);
+        }
+
+        void fail(std::exception_ptr exception) {
+            if (!has_exception_.test_and_set(std::memory_order_relaxed)) {
+                exception_ = std::move(exception);
+            }
+            canceled_.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Release the successors of a node that has completed (or was skipped) and finish
+         * the run after the last node.
+         * @details Once the run is canceled, successors are skipped right here instead of being
+         * enqueued, so a dropped node completes its successors without needing the pool.
+         */
+        template <typename Pool>
+        void complete(Pool &pool, node_state &state) {
+            std::vector<node_state *> skipped;
+            for (auto *current = &state; current != nullptr;) {
+                for (auto *next : current->successors) {
+                    if (next->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                    if (canceled_.load(std::memory_order_relaxed)) {
+                        skipped.push_back(next);
+                    } else {
+                        schedule(pool, *next);
+                    }
+                }
+                if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    finish();
+                    return;
+                }
+                current = nullptr;
+                if (!skipped.empty()) {
+                    current = skipped.back();
+                    skipped.pop_back();
+                }
+            }
+        }
+
+        void finish() {
+            // the graph may be destroyed as soon as the result is set
+            auto result = std::move(result_);
+            if (auto exception = std::exchange(exception_, nullptr)) {
+                result.set_exception(std::move(exception));
+            } else {
+                result.set_value();
+            }
+        }
+
+        // nodes are never moved, so handles and successor pointers stay valid
+        std::deque<node_state> nodes_;
+        std::atomic_size_t remaining_{0};
+        std::atomic_bool canceled_{false};
+        std::atomic_flag has_exception_{};
+        std::exception_ptr exception_{};
+        dp::promise<void> result_{};
+    };
+}  // namespace dp
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stop_token>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "drop_guard.h"
+#include "thread_pool.h"
+
+namespace dp {
+    /**
+     * @brief A set of tasks running on a thread pool that can be waited for and canceled
+     * together.
+     * @details Unlike dp::thread_pool::wait_for_tasks(), @ref wait() only waits for the tasks that
+     * were spawned into this group, so independent callers can share one pool. A group only holds
+     * a counter of pending tasks, the first exception thrown by one of them and a
+     * std::stop_source, so it is cheap enough to create one per request:
+     * @code
+     * dp::task_group group(pool);
+     * for (auto &part : parts) group.run([&part] { process(part); });
+     * group.wait();
+     * @endcode
+     * The group must outlive its tasks, which is guaranteed by the destructor waiting for them.
+     * @tparam Pool The thread pool type, usually deduced from the constructor argument.
+     */
+    template <typename Pool>
+    class task_group {
+      public:
+        explicit task_group(Pool &pool) : pool_(std::addressof(pool)) {}
+
+        /// group is non-copyable
+        task_group(const task_group &) = delete;
+        task_group &operator=(const task_group &) = delete;
+
+        /**
+         * @brief Waits for all tasks of the group, any exception is discarded.
+         */
+        ~task_group() { wait_for_pending(); }
+
+        /**
+         * @brief Spawn a task into the group. Any return value of the function will be ignored.
+         * @details Like with std::jthread, a function that can be called with a std::stop_token
+         * in front of the arguments (and not without it) receives the token of the group, which
+         * is stopped by @ref cancel().
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, Args...> ||
+                     std::invocable<Function, std::stop_token, Args...>
+        void run(Function &&func, Args &&...args) {
+            run(priority::normal, std::forward<Function>(func), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Spawn a task with the given priority into the group, see dp::priority.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, Args...> ||
+                     std::invocable<Function, std::stop_token, Args...>
+        void run(priority task_priority, Function &&func, Args &&...args) {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            // a task that is dropped without running (cleared from the pool or not enqueued
+            // because of an exception) still has to complete
+            pool_->enqueue_detach(task_priority,
+                                  [this, guard = details::drop_guard([this] { finish(); }),
+                                   f = std::forward<Function>(func),
+                                   ... largs = std::forward<Args>(args)]() mutable {
+                                      guard.dismiss();
+                                      execute(f, largs...);
+                                  });
+        }
+
+        /**
+         * @brief Block until all tasks of the group have completed.
+         * @details When called from a worker thread, that worker runs pending tasks of its pool
+         * until then, so groups can be nested without running out of workers. Afterwards the
+         * group can be reused: it is no longer canceled and the stored exception is cleared.
+         * @throws The first exception thrown by one of the tasks, if any.
+         */
+        void wait() {
+            wait_for_pending();
+
+            canceled_.store(false, std::memory_order_relaxed);
+            if (stop_source_.stop_requested()) stop_source_ = std::stop_source();
+            if (has_exception_.test(std::memory_order_acquire)) {
+                auto exception = std::exchange(exception_, nullptr);
+                has_exception_.clear(std::memory_order_relaxed);
+                std::rethrow_exception(exception);
+            }
+        }
+
+        /**
+         * @brief Cancel the group: tasks that haven't started yet are skipped. Tasks that are
+         * already running are not interrupted, but can check @ref is_canceled() or the token
+         * from @ref get_stop_token().
+         */
+        void cancel() {
+            canceled_.store(true, std::memory_order_relaxed);
+            stop_source_.request_stop();
+        }
+
+        /**
+         * @brief The token passed to tasks of the group that take a std::stop_token, stopped by
+         * @ref cancel() until the next @ref wait().
+         */
+        [[nodiscard]] std::stop_token get_stop_token() const noexcept {
+            return stop_source_.get_token();
+        }
+
+        [[nodiscard]] bool is_canceled() const {
+            return canceled_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief The number of tasks of the group that have not completed yet.
+         */
+        [[nodiscard]] std::size_t pending() const {
+            return pending_.load(std::memory_order_acquire);
+        }
+
+      private:
+        template <typename Function, typename... Args>
+        void execute(Function &f, Args &...args) {
+            if (!is_canceled()) {
+                try {
+                    if constexpr (!std::invocable<Function &, Args &...>) {
+                        // the function takes the stop token of the group
+                        invoke_ignoring_result(f, get_stop_token(), args...);
+                    } else {
+                        invoke_ignoring_result(f, args...);
+                    }
+                } catch (...) {
+                    // keep the first exception and skip the remaining tasks
+                    if (!has_exception_.test_and_set(std::memory_order_relaxed)) {
+                        exception_ = std::current_exception();
+                    }
+                    cancel();
+                }
+            }
+            finish();
+        }
+
+        template <typename Function, typename... Args>
+        static void invoke_ignoring_result(Function &f, Args &&...args) {
+            if constexpr (std::is_void_v<std::invoke_result_t<Function &, Args &&...>>) {
+                std::invoke(f, std::forward<Args>(args)...);
+            } else {
+                // the function returns a value, but it is ignored
+                std::ignore = std::invoke(f, std::forward<Args>(args)...);
+            }
+        }
+
+        void finish() {
+            if (pending_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                pending_.notify_all();
+                details::notify_waiting_workers();
+            }
+        }
+
+        void wait_for_pending() {
+            if (details::help_while_waiting([this] { return pending() == 0; })) return;
+            // must be a loop to ignore spurious wake-ups
+            for (auto pending = pending_.load(std::memory_order_acquire); pending != 0;
+                 pending = pending_.load(std::memory_order_acquire)) {
+                pending_.wait(pending, std::memory_order_acquire);
+            }
+        }
+
+        Pool *pool_;
+        std::atomic_size_t pending_{0};
+        std::atomic_bool canceled_{false};
+        std::atomic_flag has_exception_{};
+        std::exception_ptr exception_{};
+        std::stop_source stop_source_{};
+    };
+}  // namespace dp
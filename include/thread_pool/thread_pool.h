@@ -1,21 +1,48 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <future>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <semaphore>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
 #include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 #ifdef __has_include
 #    if __has_include(<version>)
 #        include <version>
 #    endif
 #endif
 
+#include "cache_line.h"
+#include "future.h"
+#include "idle_worker_tracker.h"
+#include "recycling_memory_resource.h"
+#include "statistics.h"
 #include "thread_safe_queue.h"
+#include "timer_wheel.h"
+#include "victim_selection.h"
+#include "work_stealing_deque.h"
+#include "worker_affinity.h"
+#include "worker_context.h"
+#include "worker_signal.h"
 
 namespace dp {
     namespace details {
@@ -25,12 +52,201 @@ namespace dp {
 #else
         using default_function_type = std::function<void()>;
 #endif
+
+        /**
+         * @brief Whether @p FunctionType can store a callable of type @p F, taking the inline
+         * capacity of dp::inplace_function into account.
+         */
+        template <typename FunctionType, typename F>
+        concept can_store_callable =
+            std::constructible_from<FunctionType, F> &&
+            (!requires { FunctionType::template fits<F>; } ||
+             requires { requires FunctionType::template fits<F>; });
+
+        /**
+         * @brief The future types that dp::thread_pool::enqueue can return.
+         */
+        template <template <typename> typename Future, typename T>
+        concept supported_future = std::same_as<Future<T>, std::future<T>> ||
+                                   std::same_as<Future<T>, dp::future<T>>;
+
+        /**
+         * @brief Whether task closures are allocated from the memory resource of the pool.
+         * @details Only enabled for function types that store the small allocated_closure handle
+         * inline. std::function always allocates callables that are not trivially copyable and
+         * dp::inplace_function never allocates, so neither would benefit.
+         */
+        template <typename FunctionType>
+        inline constexpr bool allocates_closures = false;
+
+#ifdef __cpp_lib_move_only_function
+        template <typename... Signature>
+        inline constexpr bool allocates_closures<std::move_only_function<Signature...>> = true;
+#endif
+
+        /**
+         * @brief Owning handle to a task closure allocated from a memory resource.
+         */
+        template <typename Closure>
+        class allocated_closure {
+          public:
+            template <typename Function>
+            allocated_closure(Function &&closure, std::pmr::memory_resource *resource)
+                : allocator_(resource),
+                  closure_(allocator_.new_object<Closure>(std::forward<Function>(closure))) {}
+
+            allocated_closure(allocated_closure &&other) noexcept
+                : allocator_(other.allocator_), closure_(std::exchange(other.closure_, nullptr)) {}
+            allocated_closure &operator=(allocated_closure &&) = delete;
+
+            ~allocated_closure() {
+                if (closure_ != nullptr) allocator_.delete_object(closure_);
+            }
+
+            void operator()() { std::invoke(*closure_); }
+
+          private:
+            std::pmr::polymorphic_allocator<> allocator_;
+            Closure *closure_;
+        };
     }  // namespace details
 
+    /**
+     * @brief Priority of a task, see dp::thread_pool::enqueue().
+     * @details Every worker has a queue per priority. Workers run and steal higher priority tasks
+     * first, tasks of the same priority run in the order they were enqueued. Running tasks are
+     * never interrupted.
+     */
+    enum class priority : std::uint8_t { high, normal, low };
+
+    /**
+     * @brief Lets a dp::thread_pool adjust its number of workers to the load.
+     * @details A background thread checks the load every @ref interval. It adds workers when
+     * more than @ref queue_depth tasks per worker are waiting to be started and retires workers
+     * that have been idle for longer than @ref idle_time.
+     */
+    struct autoscaling_policy {
+        /// whether the pool grows and shrinks automatically
+        bool enabled = false;
+        /// the pool never shrinks below this many workers
+        unsigned int min_threads = 1;
+        /// the pool never grows beyond this many workers
+        unsigned int max_threads = std::thread::hardware_concurrency();
+        /// grow once more than this many tasks per worker are waiting to be started
+        std::size_t queue_depth = 4;
+        /// retire workers that have been idle for this long
+        std::chrono::milliseconds idle_time{1000};
+        /// how often the load is checked
+        std::chrono::milliseconds interval{20};
+    };
+
+    /**
+     * @brief What dp::thread_pool::enqueue() and dp::thread_pool::enqueue_detach() do when the
+     * queues of a bounded pool are full, see thread_pool_options::queue_capacity.
+     */
+    enum class overflow_policy {
+        /// wait until the workers have started enough queued tasks. A worker of the pool runs
+        /// pending tasks in the meantime instead of blocking.
+        block,
+        /// throw dp::queue_full_error
+        fail,
+        /// run the task right away on the calling thread
+        caller_runs
+    };
+
+    /**
+     * @brief Thrown when a task is enqueued while the queues of a bounded pool are full and its
+     * overflow policy is overflow_policy::fail.
+     */
+    class queue_full_error : public std::runtime_error {
+      public:
+        queue_full_error() : std::runtime_error("dp::thread_pool: the task queues are full") {}
+    };
+
+    /**
+     * @brief Stored in the future of a task that was dropped because stop was requested on its
+     * std::stop_token before it started, see dp::thread_pool::enqueue(std::stop_token, Function,
+     * Args...).
+     */
+    class task_canceled_error : public std::runtime_error {
+      public:
+        task_canceled_error()
+            : std::runtime_error("dp::thread_pool: the task was canceled before it started") {}
+    };
+
+    /**
+     * @brief Runtime options of dp::thread_pool.
+     */
+    struct thread_pool_options {
+        /// the number of worker threads
+        unsigned int thread_count = std::thread::hardware_concurrency();
+        /**
+         * @brief The maximum number of workers that dp::thread_pool::resize() can grow the pool
+         * to, 0 means @ref thread_count. The per-worker task queues are allocated up front.
+         */
+        unsigned int max_thread_count = 0;
+        /// grow and shrink the pool automatically, see dp::autoscaling_policy
+        autoscaling_policy autoscaling{};
+        /**
+         * @brief Memory resource used for task closures, future shared states and the task
+         * queues, for example a dp::recycling_memory_resource. Must outlive the pool. If null,
+         * the global allocator is used.
+         */
+        std::pmr::memory_resource *memory_resource = nullptr;
+        /// how workers wait for new tasks, and tasks waiting on a worker for a dp::future, a
+        /// dp::task_group or dp::parallel_for when there is nothing to run, see dp::idle_strategy
+        idle_strategy idle{};
+        /// how workers pick the workers they steal tasks from, see dp::victim_selection
+        victim_selection victims = victim_selection::sequential;
+        /// which CPUs the workers run on, see dp::worker_affinity
+        worker_affinity affinity{};
+        /**
+         * @brief Prevents starvation of lower priority tasks: after this many higher priority
+         * tasks in a row, a worker runs a waiting lower priority task from its own queues first.
+         * 0 disables aging, i.e. lower priority tasks only run once no higher priority ones are
+         * left.
+         */
+        std::uint32_t priority_aging = 0;
+        /**
+         * @brief Granularity of delayed and periodic tasks, see dp::thread_pool::enqueue_after().
+         * Deadlines are rounded up to a multiple of it.
+         */
+        std::chrono::steady_clock::duration timer_resolution = std::chrono::milliseconds(1);
+        /**
+         * @brief The maximum number of tasks waiting to be started across all workers, 0 means
+         * unbounded. Once reached, enqueuing follows the @ref overflow policy.
+         */
+        std::size_t queue_capacity = 0;
+        /// what to do when the queues are full, see dp::overflow_policy
+        overflow_policy overflow = overflow_policy::block;
+    };
+
+    /**
+     * @brief Requirements for the per-worker task queue of the thread_pool.
+     * @details push_back() and clear() can be called from any thread, pop_front() is called by the
+     * worker that owns the queue and steal() is called by other workers. See
+     * dp::thread_safe_queue and dp::work_stealing_deque.
+     *
+     * Queues can optionally provide `append_range()` for bulk enqueues and
+     * `steal_batch(destination)`, which steals multiple tasks at once, returning one of them and
+     * moving the others to the queue of the thief. If it also accepts a `std::size_t *` that
+     * receives the number of moved tasks, dp::thread_pool::stats() counts every stolen task.
+     */
+    template <typename Queue, typename T>
+    concept is_task_queue = requires(Queue &queue, T &&value) {
+        queue.push_back(std::move(value));
+        { queue.pop_front() } -> std::same_as<std::optional<T>>;
+        { queue.steal() } -> std::same_as<std::optional<T>>;
+        { queue.clear() } -> std::convertible_to<std::size_t>;
+        { queue.empty() } -> std::convertible_to<bool>;
+    };
+
     template <typename FunctionType = details::default_function_type,
-              typename ThreadType = std::jthread>
+              typename ThreadType = std::jthread,
+              typename QueueType = dp::thread_safe_queue<FunctionType>>
         requires std::invocable<FunctionType> &&
-                 std::is_same_v<void, std::invoke_result_t<FunctionType>>
+                 std::is_same_v<void, std::invoke_result_t<FunctionType>> &&
+                 is_task_queue<QueueType, FunctionType>
     class thread_pool {
       public:
         template <typename InitializationFunction = std::function<void(std::size_t)>>
@@ -39,86 +255,81 @@ namespace dp {
         explicit thread_pool(
             const unsigned int &number_of_threads = std::thread::hardware_concurrency(),
             InitializationFunction init = [](std::size_t) {})
-            : tasks_(number_of_threads) {
-            std::size_t current_id = 0;
-            for (std::size_t i = 0; i < number_of_threads; ++i) {
-                priority_queue_.push_back(size_t(current_id));
-                try {
-                    threads_.emplace_back([&, id = current_id,
-                                           init](const std::stop_token &stop_tok) {
-                        // invoke the init function on the thread
-                        try {
-                            std::invoke(init, id);
-                        } catch (...) {
-                            // suppress exceptions
-                        }
-
-                        do {
-                            // wait until signaled
-                            tasks_[id].signal.acquire();
-
-                            do {
-                                // invoke the task
-                                while (auto task = tasks_[id].tasks.pop_front()) {
-                                    // decrement the unassigned tasks as the task is now going
-                                    // to be executed
-                                    unassigned_tasks_.fetch_sub(1, std::memory_order_release);
-                                    // invoke the task
-                                    std::invoke(std::move(task.value()));
-                                    // the above task can push more work onto the pool, so we
-                                    // only decrement the in flights once the task has been
-                                    // executed because now it's now longer "in flight"
-                                    in_flight_tasks_.fetch_sub(1, std::memory_order_release);
-                                }
-
-                                // try to steal a task
-                                for (std::size_t j = 1; j < tasks_.size(); ++j) {
-                                    const std::size_t index = (id + j) % tasks_.size();
-                                    if (auto task = tasks_[index].tasks.steal()) {
-                                        // steal a task
-                                        unassigned_tasks_.fetch_sub(1, std::memory_order_release);
-                                        std::invoke(std::move(task.value()));
-                                        in_flight_tasks_.fetch_sub(1, std::memory_order_release);
-                                        // stop stealing once we have invoked a stolen task
-                                        break;
-                                    }
-                                }
-                                // check if there are any unassigned tasks before rotating to the
-                                // front and waiting for more work
-                            } while (unassigned_tasks_.load(std::memory_order_acquire) > 0);
-
-                            priority_queue_.rotate_to_front(id);
-                            // check if all tasks are completed and release the "barrier"
-                            if (in_flight_tasks_.load(std::memory_order_acquire) == 0) {
-                                // in theory, only one thread will set this
-                                threads_complete_signal_.store(true, std::memory_order_release);
-                                threads_complete_signal_.notify_one();
-                            }
+            : thread_pool(thread_pool_options{.thread_count = number_of_threads},
+                          std::move(init)) {}
 
-                        } while (!stop_tok.stop_requested());
-                    });
-                    // increment the thread id
-                    ++current_id;
+        template <typename InitializationFunction = std::function<void(std::size_t)>>
+            requires std::invocable<InitializationFunction, std::size_t> &&
+                     std::is_same_v<void, std::invoke_result_t<InitializationFunction, std::size_t>>
+        explicit thread_pool(
+            const thread_pool_options &options, InitializationFunction init = [](std::size_t) {})
+            : idle_workers_(max_workers(options)),
+              memory_resource_(options.memory_resource),
+              idle_strategy_(options.idle),
+              victim_selector_(options.victims, max_workers(options)),
+              worker_cpus_(details::plan_worker_cpus(options.affinity, max_workers(options))),
+              priority_aging_(options.priority_aging),
+              init_(std::move(init)),
+              autoscaling_(options.autoscaling),
+              timer_epoch_(std::chrono::steady_clock::now()),
+              timer_resolution_(std::max(options.timer_resolution,
+                                         std::chrono::steady_clock::duration{1})),
+              queue_capacity_(options.queue_capacity),
+              overflow_(options.overflow) {
+            for (std::size_t i = 0; i < max_workers(options); ++i) {
+                if constexpr (std::constructible_from<QueueType, std::pmr::memory_resource *>) {
+                    if (memory_resource_ != nullptr) {
+                        tasks_.emplace_back(memory_resource_);
+                        continue;
+                    }
+                }
+                tasks_.emplace_back();
+            }
 
-                } catch (...) {
-                    // catch all
+            // normalize the bounds once, so that 1 <= min_threads <= max_threads <= max_size()
+            autoscaling_.max_threads = static_cast<unsigned int>(
+                std::clamp<std::size_t>(autoscaling_.max_threads, 1, tasks_.size()));
+            autoscaling_.min_threads =
+                std::clamp(autoscaling_.min_threads, 1U, autoscaling_.max_threads);
 
-                    // remove one item from the tasks
-                    tasks_.pop_back();
+            auto thread_count = static_cast<std::size_t>(options.thread_count);
+            if (autoscaling_.enabled) {
+                thread_count = std::clamp<std::size_t>(thread_count, autoscaling_.min_threads,
+                                                       autoscaling_.max_threads);
+            }
+            for (std::size_t i = 0; i < thread_count; ++i) {
+                // a worker that fails to start is skipped, the ids of the workers stay dense
+                std::ignore = start_worker();
+            }
 
-                    // remove our thread from the priority queue
-                    std::ignore = priority_queue_.pop_back();
-                }
+            if (autoscaling_.enabled) {
+                autoscaler_.emplace(
+                    [this](const std::stop_token &stop_tok) { autoscale(stop_tok); });
             }
         }
 
         ~thread_pool() {
+            // timers that have not expired yet are dropped
+            if (timer_thread_) {
+                timer_thread_->request_stop();
+                timer_thread_->join();
+            }
+            // release the tasks of one-shot timers that will never run, their handles may outlive
+            // the pool
+            timers_.erase_if([](const timer_entry &entry) {
+                if (entry.oneshot) std::ignore = entry.oneshot->claim();
+                return true;
+            });
+            if (autoscaler_) {
+                autoscaler_->request_stop();
+                autoscaler_->join();
+            }
             wait_for_tasks();
 
             // stop all threads
             for (std::size_t i = 0; i < threads_.size(); ++i) {
                 threads_[i].request_stop();
-                tasks_[i].signal.release();
+                tasks_[i].signal.notify();
                 threads_[i].join();
             }
         }
@@ -135,64 +346,183 @@ namespace dp {
          * @tparam ReturnType The return type of the Function
          * @param f The callable function
          * @param args The parameters that will be passed (copied) to the function.
-         * @return A std::future<ReturnType> that can be used to retrieve the returned value.
+         * @tparam Future The future template to return, std::future (default) or the lighter
+         * dp::future, e.g. `pool.enqueue<dp::future>(f, args...)`. Waiting on a dp::future from
+         * a task runs other pending tasks in the meantime, while std::future always blocks.
+         * @return A Future<ReturnType> that can be used to retrieve the returned value.
+         * @throws dp::queue_full_error if the pool is bounded, full and its overflow policy is
+         * overflow_policy::fail.
          */
-        template <typename Function, typename... Args,
+        template <template <typename> typename Future = std::future, typename Function,
+                  typename... Args,
                   typename ReturnType = std::invoke_result_t<Function &&, Args &&...>>
-            requires std::invocable<Function, Args...>
-        [[nodiscard]] std::future<ReturnType> enqueue(Function f, Args... args) {
-#ifdef __cpp_lib_move_only_function
-            // we can do this in C++23 because we now have support for move only functions
-            std::promise<ReturnType> promise;
-            auto future = promise.get_future();
-            auto task = [func = std::move(f), ... largs = std::move(args),
-                         promise = std::move(promise)]() mutable {
-                try {
-                    if constexpr (std::is_same_v<ReturnType, void>) {
-                        func(largs...);
-                        promise.set_value();
-                    } else {
-                        promise.set_value(func(largs...));
-                    }
-                } catch (...) {
-                    promise.set_exception(std::current_exception());
-                }
-            };
-            enqueue_task(std::move(task));
-            return future;
-#else
-            /*
-             * use shared promise here so that we don't break the promise later (until C++23)
-             *
-             * with C++23 we can do the following:
-             *
-             * std::promise<ReturnType> promise;
-             * auto future = promise.get_future();
-             * auto task = [func = std::move(f), ...largs = std::move(args),
-                              promise = std::move(promise)]() mutable {...};
-             */
-            auto shared_promise = std::make_shared<std::promise<ReturnType>>();
-            auto task = [func = std::move(f), ... largs = std::move(args),
-                         promise = shared_promise]() {
-                try {
-                    if constexpr (std::is_same_v<ReturnType, void>) {
-                        func(largs...);
-                        promise->set_value();
-                    } else {
-                        promise->set_value(func(largs...));
-                    }
+            requires std::invocable<Function, Args...> &&
+                     details::supported_future<Future, ReturnType>
+        [[nodiscard]] Future<ReturnType> enqueue(Function f, Args... args) {
+            auto [task, future] = make_task<Future>(std::move(f), std::move(args)...);
+            submit(std::move(task), priority::normal);
+            return std::move(future);
+        }
 
-                } catch (...) {
-                    promise->set_exception(std::current_exception());
-                }
-            };
+        /**
+         * @brief Enqueue a task with the given priority that returns a result.
+         * @details Workers run higher priority tasks first, see dp::priority. Otherwise the same
+         * as @ref enqueue(Function, Args...).
+         * @param task_priority The priority of the task.
+         * @param f The callable function
+         * @param args The parameters that will be passed (copied) to the function.
+         * @return A Future<ReturnType> that can be used to retrieve the returned value.
+         */
+        template <template <typename> typename Future = std::future, typename Function,
+                  typename... Args,
+                  typename ReturnType = std::invoke_result_t<Function &&, Args &&...>>
+            requires std::invocable<Function, Args...> &&
+                     details::supported_future<Future, ReturnType>
+        [[nodiscard]] Future<ReturnType> enqueue(priority task_priority, Function f,
+                                                 Args... args) {
+            auto [task, future] = make_task<Future>(std::move(f), std::move(args)...);
+            submit(std::move(task), task_priority);
+            return std::move(future);
+        }
+
+        /**
+         * @brief Enqueue a cancellable task that returns a result.
+         * @details The function receives @p token as its first argument, so that it can stop
+         * early once stop is requested. If stop is requested before the task starts, it is
+         * dropped without calling the function and the future throws dp::task_canceled_error.
+         * The token can come from a std::stop_source per task or shared by a set of tasks, see
+         * also get_stop_token() and dp::task_group::get_stop_token().
+         * @param token The token to pass to the function.
+         * @param f The callable function, taking a std::stop_token as first argument.
+         * @param args The parameters that will be passed (copied) to the function after the
+         * token.
+         * @return A Future<ReturnType> that can be used to retrieve the returned value.
+         */
+        template <template <typename> typename Future = std::future, typename Function,
+                  typename... Args,
+                  typename ReturnType =
+                      std::invoke_result_t<Function &&, std::stop_token, Args &&...>>
+            requires std::invocable<Function, std::stop_token, Args...> &&
+                     details::supported_future<Future, ReturnType>
+        [[nodiscard]] Future<ReturnType> enqueue(std::stop_token token, Function f,
+                                                 Args... args) {
+            auto [task, future] = make_task<Future>(
+                [token, func = std::move(f)](auto &&...largs) -> ReturnType {
+                    if (token.stop_requested()) throw task_canceled_error();
+                    return std::invoke(func, token, std::forward<decltype(largs)>(largs)...);
+                },
+                std::move(args)...);
+            submit(std::move(task), priority::normal);
+            return std::move(future);
+        }
+
+        /**
+         * @brief Enqueue a task that takes a std::stop_token, passing it the token of the pool.
+         * @details Like with std::jthread, functions that can be called with a std::stop_token
+         * in front of the arguments (and not without it) receive one. See request_stop() and
+         * @ref enqueue(std::stop_token, Function, Args...).
+         */
+        template <template <typename> typename Future = std::future, typename Function,
+                  typename... Args,
+                  typename ReturnType =
+                      std::invoke_result_t<Function &&, std::stop_token, Args &&...>>
+            requires std::invocable<Function, std::stop_token, Args...> &&
+                     (!std::invocable<Function, Args...>) &&
+                     details::supported_future<Future, ReturnType>
+        [[nodiscard]] Future<ReturnType> enqueue(Function f, Args... args) {
+            return enqueue<Future>(get_stop_token(), std::move(f), std::move(args)...);
+        }
+
+        /**
+         * @brief Enqueue a cancellable task, any return value of the function will be ignored.
+         * @details The function receives @p token as its first argument. If stop is requested
+         * before the task starts, it is dropped without calling the function. See
+         * @ref enqueue(std::stop_token, Function, Args...).
+         * @param token The token to pass to the function.
+         * @param func The callable to be executed, taking a std::stop_token as first argument.
+         * @param args Arguments that will be passed to the function after the token.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, std::stop_token, Args...>
+        void enqueue_detach(std::stop_token token, Function &&func, Args &&...args) {
+            // abandoned work is not even queued
+            if (token.stop_requested()) return;
+            auto task = make_detached_task(std::forward<Function>(func), token,
+                                           std::forward<Args>(args)...);
+            submit(
+                [token, task = std::move(task)]() mutable {
+                    if (!token.stop_requested()) task();
+                },
+                priority::normal);
+        }
+
+        /**
+         * @brief Enqueue a task that takes a std::stop_token, passing it the token of the pool.
+         * Any return value of the function will be ignored.
+         * @details See @ref enqueue(Function, Args...) for tasks taking a std::stop_token.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, std::stop_token, Args...> &&
+                     (!std::invocable<Function, Args...>)
+        void enqueue_detach(Function &&func, Args &&...args) {
+            enqueue_detach(get_stop_token(), std::forward<Function>(func),
+                           std::forward<Args>(args)...);
+        }
 
-            // get the future before enqueuing the task
-            auto future = shared_promise->get_future();
-            // enqueue the task
+        /**
+         * @brief The token passed to tasks that take a std::stop_token, unless they were
+         * enqueued with a token of their own.
+         */
+        [[nodiscard]] std::stop_token get_stop_token() const noexcept {
+            return stop_source_.get_token();
+        }
+
+        /**
+         * @brief Cancel all tasks that received the token of the pool: queued ones are dropped
+         * without running and running ones can see the request through their token. Tasks
+         * enqueued afterwards with the pool token are dropped right away, other tasks are not
+         * affected. Can not be undone, e.g. call it before destroying the pool to abandon the
+         * remaining work.
+         * @return true if this call made the stop request.
+         */
+        bool request_stop() noexcept { return stop_source_.request_stop(); }
+
+        /**
+         * @brief Enqueue a task that returns a result, unless the queues of a bounded pool are
+         * full.
+         * @details Never blocks, regardless of the overflow policy of the pool. See
+         * @ref enqueue(Function, Args...) and thread_pool_options::queue_capacity.
+         * @param f The callable function
+         * @param args The parameters that will be passed (copied) to the function.
+         * @return The future of the task or std::nullopt if the queues are full.
+         */
+        template <template <typename> typename Future = std::future, typename Function,
+                  typename... Args,
+                  typename ReturnType = std::invoke_result_t<Function &&, Args &&...>>
+            requires std::invocable<Function, Args...> &&
+                     details::supported_future<Future, ReturnType>
+        [[nodiscard]] std::optional<Future<ReturnType>> try_enqueue(Function f, Args... args) {
+            if (!reserve_queue_slots(1, overflow_policy::fail)) return std::nullopt;
+            auto [task, future] = make_task<Future>(std::move(f), std::move(args)...);
             enqueue_task(std::move(task));
-            return future;
-#endif
+            return std::optional<Future<ReturnType>>(std::move(future));
+        }
+
+        /**
+         * @brief Enqueue a task unless the queues of a bounded pool are full. Any return value of
+         * the function will be ignored.
+         * @details Never blocks, regardless of the overflow policy of the pool.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function.
+         * @return false if the queues are full and the task was not enqueued.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, Args...>
+        [[nodiscard]] bool try_enqueue_detach(Function &&func, Args &&...args) {
+            if (!reserve_queue_slots(1, overflow_policy::fail)) return false;
+            enqueue_task(
+                make_detached_task(std::forward<Function>(func), std::forward<Args>(args)...));
+            return true;
         }
 
         /**
@@ -206,21 +536,222 @@ namespace dp {
         template <typename Function, typename... Args>
             requires std::invocable<Function, Args...>
         void enqueue_detach(Function &&func, Args &&...args) {
-            enqueue_task(std::move([f = std::forward<Function>(func),
-                                    ... largs =
-                                        std::forward<Args>(args)]() mutable -> decltype(auto) {
-                // suppress exceptions
-                try {
-                    if constexpr (std::is_same_v<void,
-                                                 std::invoke_result_t<Function &&, Args &&...>>) {
-                        std::invoke(f, largs...);
-                    } else {
-                        // the function returns an argument, but can be ignored
-                        std::ignore = std::invoke(f, largs...);
-                    }
-                } catch (...) {
-                }
-            }));
+            submit(make_detached_task(std::forward<Function>(func), std::forward<Args>(args)...),
+                   priority::normal);
+        }
+
+        /**
+         * @brief Enqueue a task with the given priority to be executed in the thread pool. Any
+         * return value of the function will be ignored.
+         * @details Workers run higher priority tasks first, see dp::priority.
+         * @param task_priority The priority of the task.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function.
+         */
+        template <typename Function, typename... Args>
+            requires std::invocable<Function, Args...>
+        void enqueue_detach(priority task_priority, Function &&func, Args &&...args) {
+            submit(make_detached_task(std::forward<Function>(func), std::forward<Args>(args)...),
+                   task_priority);
+        }
+
+        /**
+         * @brief Enqueue a task that continues work that was already submitted to the pool, like
+         * the chunks of dp::parallel_for or the nodes of a dp::task_graph. Any return value of the
+         * function will be ignored.
+         * @details Unlike @ref enqueue_detach(), the task is never delayed or rejected by the
+         * overflow policy of a bounded pool: rejecting it would abandon work that has already
+         * been admitted, and blocking it could stall the workers that have to make room.
+         * @param func The callable to be executed
+         */
+        template <typename Function>
+            requires std::invocable<Function>
+        void enqueue_continuation(Function &&func) {
+            force_reserve_queue_slots(1);
+            enqueue_task(make_detached_task(std::forward<Function>(func)));
+        }
+
+        /**
+         * @brief Awaitable that resumes the awaiting coroutine on a worker of the pool, see
+         * schedule().
+         */
+        class schedule_awaiter {
+          public:
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> awaiting) {
+                // resuming is never delayed by the overflow policy of a bounded pool
+                pool_->force_reserve_queue_slots(1);
+                // small enough to be stored inline by the function type, so nothing is allocated.
+                // Without a worker to resume it, the coroutine continues on this thread instead
+                // of being suspended forever.
+                return pool_->enqueue_task(FunctionType([awaiting] { awaiting.resume(); }),
+                                           priority_);
+            }
+
+            void await_resume() const noexcept {}
+
+          private:
+            friend class thread_pool;
+            schedule_awaiter(thread_pool *pool, priority task_priority)
+                : pool_(pool), priority_(task_priority) {}
+
+            thread_pool *pool_;
+            priority priority_;
+        };
+
+        /**
+         * @brief Continue the calling coroutine on a worker of this pool:
+         * `co_await pool.schedule();`
+         * @details The coroutine handle is queued like a task, but without a promise, a future or
+         * a closure allocation, and the worker resumes the coroutine frame directly. Awaited on
+         * a worker of this pool, the coroutine goes to that worker's own queue where idle workers
+         * can steal it. If the pool has no workers, the coroutine is not suspended and continues
+         * on the calling thread. See also dp::task.
+         * @param task_priority The priority of the resumption, see dp::priority.
+         */
+        [[nodiscard]] schedule_awaiter schedule(priority task_priority = priority::normal) {
+            return schedule_awaiter(this, task_priority);
+        }
+
+        /**
+         * @brief Enqueue a range of tasks that return a result in a single operation.
+         * @details The tasks are split into one batch per worker and each batch is pushed with a
+         * single queue operation. Tasks can also be generated on the fly with a view, for example
+         * `std::views::iota(0, n) | std::views::transform(make_task)`. A bounded pool applies its
+         * overflow policy to all tasks at once, a batch larger than the capacity is let through
+         * once the queues are empty.
+         * @tparam Range An input range of invokable types that take no arguments.
+         * @param functions The callables to be executed.
+         * @tparam Future The future template to return, see @ref enqueue().
+         * @return The futures for each task, in the same order as @p functions.
+         */
+        template <template <typename> typename Future = std::future,
+                  std::ranges::input_range Range,
+                  typename Function = std::remove_cvref_t<std::ranges::range_reference_t<Range>>,
+                  typename ReturnType = std::invoke_result_t<Function &&>>
+            requires std::invocable<Function> && details::supported_future<Future, ReturnType>
+        [[nodiscard]] std::vector<Future<ReturnType>> enqueue_bulk(Range &&functions) {
+            std::pmr::vector<FunctionType> tasks(task_resource());
+            std::vector<Future<ReturnType>> futures;
+            if constexpr (std::ranges::sized_range<Range>) {
+                tasks.reserve(std::ranges::size(functions));
+                futures.reserve(std::ranges::size(functions));
+            }
+
+            for (auto &&function : functions) {
+                auto [task, future] =
+                    make_task<Future>(Function(std::forward<decltype(function)>(function)));
+                tasks.emplace_back(make_function(std::move(task)));
+                futures.emplace_back(std::move(future));
+            }
+
+            submit_bulk(tasks);
+            return futures;
+        }
+
+        /**
+         * @brief Enqueue a range of tasks in a single operation. Any return value of the functions
+         * will be ignored.
+         * @details See @ref enqueue_bulk() for details.
+         * @tparam Range An input range of invokable types that take no arguments.
+         * @param functions The callables to be executed.
+         */
+        template <std::ranges::input_range Range,
+                  typename Function = std::remove_cvref_t<std::ranges::range_reference_t<Range>>>
+            requires std::invocable<Function>
+        void enqueue_detach_bulk(Range &&functions) {
+            std::pmr::vector<FunctionType> tasks(task_resource());
+            if constexpr (std::ranges::sized_range<Range>) {
+                tasks.reserve(std::ranges::size(functions));
+            }
+
+            for (auto &&function : functions) {
+                tasks.emplace_back(make_function(
+                    make_detached_task(Function(std::forward<decltype(function)>(function)))));
+            }
+
+            submit_bulk(tasks);
+        }
+
+        /**
+         * @brief Run a task once @p delay has passed. Any return value of the function will be
+         * ignored.
+         * @details Pending timers live in a hierarchical timer wheel served by a single timer
+         * thread, started with the first timer, which sleeps until the next deadline. No worker
+         * is blocked in the meantime. Expired tasks are handed to the workers in batches, like
+         * with @ref enqueue_detach_bulk(). wait_for_tasks() does not wait for timers that have not
+         * expired yet and timers still pending when the pool is destroyed never run.
+         * @param delay How long to wait, rounded up to thread_pool_options::timer_resolution.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function.
+         * @return A handle to cancel the task.
+         */
+        template <typename Rep, typename Period, typename Function, typename... Args>
+            requires std::invocable<Function, Args...>
+        timer_handle enqueue_after(std::chrono::duration<Rep, Period> delay, Function &&func,
+                                   Args &&...args) {
+            return enqueue_at(std::chrono::steady_clock::now() + delay,
+                              std::forward<Function>(func), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Run a task at the given point in time. Any return value of the function will be
+         * ignored.
+         * @details Points in time of other clocks than std::chrono::steady_clock are converted
+         * when the task is enqueued, later adjustments of that clock are not taken into account.
+         * See @ref enqueue_after() for details.
+         * @param time When to run the task, tasks with a point in time in the past run right
+         * away.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function.
+         * @return A handle to cancel the task.
+         */
+        template <typename Clock, typename Duration, typename Function, typename... Args>
+            requires std::invocable<Function, Args...>
+        timer_handle enqueue_at(std::chrono::time_point<Clock, Duration> time, Function &&func,
+                                Args &&...args) {
+            const std::pmr::polymorphic_allocator<> allocator(task_resource());
+            auto state = std::allocate_shared<oneshot_timer>(allocator, canceled_timers_);
+            // a weak reference, the state owns the task until the timer expires
+            state->task = make_function(
+                [timer = std::weak_ptr<oneshot_timer>(state),
+                 job = make_detached_task(std::forward<Function>(func),
+                                          std::forward<Args>(args)...)]() mutable {
+                    const auto current = timer.lock();
+                    if (!current || !current->canceled.load(std::memory_order_relaxed)) job();
+                });
+            add_timer(deadline_tick(time), timer_entry{state, state, nullptr});
+            return timer_handle(std::move(state));
+        }
+
+        /**
+         * @brief Run a task every @p period, starting one period from now, until it is canceled.
+         * Any return value of the function will be ignored.
+         * @details Runs are scheduled at a fixed rate. A run is skipped if the previous one is
+         * still in progress, so runs of the same timer never overlap. See @ref enqueue_after() for
+         * details.
+         * @param period The time between runs, rounded up to
+         * thread_pool_options::timer_resolution.
+         * @param func The callable to be executed
+         * @param args Arguments that will be passed to the function on every run.
+         * @return A handle to cancel the timer.
+         */
+        template <typename Rep, typename Period, typename Function, typename... Args>
+            requires std::invocable<Function &, Args &...>
+        timer_handle enqueue_every(std::chrono::duration<Rep, Period> period, Function &&func,
+                                   Args &&...args) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto period_ticks =
+                std::max<std::uint64_t>(deadline_tick(now + period) - deadline_tick(now), 1);
+            const std::pmr::polymorphic_allocator<> allocator(task_resource());
+            auto timer = std::allocate_shared<periodic_timer>(
+                allocator, canceled_timers_,
+                make_function(
+                    make_detached_task(std::forward<Function>(func), std::forward<Args>(args)...)),
+                period_ticks);
+            add_timer(deadline_tick(now) + period_ticks, timer_entry{timer, nullptr, timer});
+            return timer_handle(std::move(timer));
         }
 
         /**
@@ -228,17 +759,72 @@ namespace dp {
          *
          * @return std::size_t The number of threads in the pool.
          */
-        [[nodiscard]] auto size() const { return threads_.size(); }
+        [[nodiscard]] std::size_t size() const {
+            return worker_count_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Change the number of workers at runtime.
+         * @details New workers call the initialization function like the initial ones, with ids
+         * continuing after the existing workers. Shrinking retires the workers with the highest
+         * ids: each one finishes the task it is running and exits, its remaining tasks are stolen
+         * by the other workers. This blocks until the retired workers have exited.
+         * @param thread_count The new number of workers, clamped to [1,
+         * thread_pool_options::max_thread_count].
+         * @throws std::logic_error if called from a task of this pool, as it could have to wait
+         * for its own worker to exit.
+         */
+        void resize(std::size_t thread_count) {
+            if (details::current_worker.pool == this) {
+                throw std::logic_error("dp::thread_pool::resize() called from one of its tasks");
+            }
+            std::scoped_lock lock(resize_mutex_);
+            resize_workers(std::clamp<std::size_t>(thread_count, 1, tasks_.size()));
+        }
+
+        /**
+         * @brief The maximum number of workers, see thread_pool_options::max_thread_count.
+         */
+        [[nodiscard]] std::size_t max_size() const { return tasks_.size(); }
+
+        /**
+         * @brief The CPUs a worker was pinned to, see dp::worker_affinity.
+         * @param worker The id of the worker, as passed to the initialization function.
+         * @return The CPUs, or an empty span if the worker is not pinned, either because no
+         * affinity was requested, the worker hasn't started yet or pinning it failed.
+         */
+        [[nodiscard]] std::span<const int> worker_cpus(std::size_t worker) const {
+            if (worker >= worker_cpus_.size()) return {};
+            if (!tasks_[worker].pinned.load(std::memory_order_acquire)) return {};
+            return worker_cpus_[worker];
+        }
 
         /**
          * @brief Wait for all tasks to finish.
-         * @details This function will block until all tasks have been completed.
+         * @details This function will block until all tasks have been completed. When called
+         * from a task of this pool, it waits for all other tasks instead and the worker runs
+         * pending tasks in the meantime rather than blocking.
          */
         void wait_for_tasks() {
-            // must be a while loop to ignore spurious wake-ups
-            while (in_flight_tasks_.load(std::memory_order_acquire) > 0) {
+            if (details::current_worker.pool == this) {
+                // the calling task (and any other task waiting here) can't complete before
+                // this returns
+                waiting_tasks_.fetch_add(1, std::memory_order_seq_cst);
+                // the other waiting tasks may have been waiting for just this one
+                details::notify_waiting_workers();
+                details::help_while_waiting([this] {
+                    return in_flight_tasks() <= waiting_tasks_.load(std::memory_order_seq_cst);
+                });
+                waiting_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+                return;
+            }
+            // must be a loop to ignore spurious wake-ups
+            while (true) {
+                // read the epoch first so that we can't miss the notification of the last task
+                const auto epoch = tasks_completed_.load(std::memory_order_acquire);
+                if (!has_in_flight_tasks()) return;
                 // wait for all tasks to finish
-                threads_complete_signal_.wait(false);
+                tasks_completed_.wait(epoch, std::memory_order_acquire);
             }
         }
 
@@ -251,51 +837,1108 @@ namespace dp {
          */
         size_t clear_tasks() {
             size_t removed_task_count{0};
-            for (auto &task_list : tasks_) {
-                removed_task_count += task_list.tasks.clear();
+            for (auto &task_list : used_slots()) {
+                std::size_t removed = 0;
+                for (auto &queue : task_list.queues) removed += queue.clear();
+                // the removed tasks will never be started, so they no longer count as submitted
+                task_list.submitted.fetch_sub(static_cast<std::int64_t>(removed),
+                                              std::memory_order_seq_cst);
+                removed_task_count += removed;
             }
-            in_flight_tasks_.fetch_sub(removed_task_count, std::memory_order_release);
-            unassigned_tasks_.fetch_sub(removed_task_count, std::memory_order_release);
+            release_queue_slots(removed_task_count);
 
+            // there may be no worker left to notice that the pool is now empty
+            if (removed_task_count > 0 && !has_in_flight_tasks()) {
+                tasks_completed_.fetch_add(1, std::memory_order_release);
+                tasks_completed_.notify_all();
+            }
             return removed_task_count;
         }
 
-      private:
-        template <typename Function>
-        void enqueue_task(Function &&f) {
-            auto i_opt = priority_queue_.copy_front_and_rotate_to_back();
-            if (!i_opt.has_value()) {
-                // would only be a problem if there are zero threads
-                return;
+        /**
+         * @brief Take a snapshot of the statistics of the pool and its workers.
+         * @details Workers keep their counters in relaxed atomics on their own cache lines, so
+         * collecting them costs next to nothing. The snapshot is not atomic, counters of
+         * different workers may be read at slightly different times. Except for the task counts
+         * and queue depths, all counters are zero if the library was built with
+         * `TP_DISABLE_STATISTICS` defined (CMake option `TP_ENABLE_STATISTICS=OFF`). The start
+         * latency is measured for one in 64 tasks per enqueuing thread, excluding bulk enqueues.
+         */
+        [[nodiscard]] thread_pool_statistics stats() const {
+            thread_pool_statistics result;
+            for (const auto &item : used_slots()) {
+                auto &worker = result.workers.emplace_back();
+                if constexpr (details::collect_statistics) item.counters.read(worker);
+                worker.tasks_executed =
+                    static_cast<std::uint64_t>(item.completed.load(std::memory_order_relaxed));
+                for (const auto &queue : item.queues) worker.queue_depth += queue_depth(queue);
             }
-            // get the index
-            auto i = *(i_opt);
-
-            // increment the unassigned tasks and in flight tasks
-            unassigned_tasks_.fetch_add(1, std::memory_order_release);
-            const auto prev_in_flight = in_flight_tasks_.fetch_add(1, std::memory_order_release);
-
-            // reset the in flight signal if the list was previously empty
-            if (prev_in_flight == 0) {
-                threads_complete_signal_.store(false, std::memory_order_release);
+            result.queued_tasks =
+                static_cast<std::size_t>(std::max<std::int_fast64_t>(unassigned_tasks(), 0));
+            result.in_flight_tasks =
+                static_cast<std::size_t>(std::max<std::int_fast64_t>(in_flight_tasks(), 0));
+            {
+                std::scoped_lock lock(timer_mutex_);
+                const auto canceled = std::max<std::int_fast64_t>(
+                    canceled_timers_->load(std::memory_order_relaxed), 0);
+                result.pending_timers =
+                    timers_.size() - std::min(static_cast<std::size_t>(canceled), timers_.size());
             }
+            return result;
+        }
 
-            // assign work
-            tasks_[i].tasks.push_back(std::forward<Function>(f));
-            tasks_[i].signal.release();
+      private:
+        /**
+         * @brief Wrap a function and its arguments into a task that fulfills a promise.
+         * @return The task and the future that is tied to it.
+         */
+        template <template <typename> typename Future, typename Function, typename... Args,
+                  typename ReturnType = std::invoke_result_t<Function &&, Args &&...>>
+        auto make_task(Function f, Args... args) {
+            if constexpr (std::same_as<Future<ReturnType>, dp::future<ReturnType>>) {
+                // dp::promise is copyable, so the task works with std::function as well
+                dp::promise<ReturnType> promise(task_resource());
+                auto future = promise.get_future();
+                auto task = [func = std::move(f), ... largs = std::move(args),
+                             promise = std::move(promise)]() mutable {
+                    try {
+                        if constexpr (std::is_same_v<ReturnType, void>) {
+                            func(largs...);
+                            promise.set_value();
+                        } else {
+                            promise.set_value(func(largs...));
+                        }
+                    } catch (...) {
+                        promise.set_exception(std::current_exception());
+                    }
+                };
+                return std::pair{std::move(task), std::move(future)};
+            } else {
+                return make_std_task(std::move(f), std::move(args)...);
+            }
         }
 
-        struct task_item {
-            dp::thread_safe_queue<FunctionType> tasks{};
-            std::binary_semaphore signal{0};
-        };
+        /**
+         * @brief Wrap a function and its arguments into a task that fulfills a std::promise.
+         */
+        template <typename Function, typename... Args,
+                  typename ReturnType = std::invoke_result_t<Function &&, Args &&...>>
+        auto make_std_task(Function f, Args... args) {
+            const std::pmr::polymorphic_allocator<> allocator(task_resource());
+            if constexpr (!std::is_copy_constructible_v<FunctionType>) {
+                // move only function types (like std::move_only_function) can own the promise
+                std::promise<ReturnType> promise(std::allocator_arg, allocator);
+                auto future = promise.get_future();
+                auto task = [func = std::move(f), ... largs = std::move(args),
+                             promise = std::move(promise)]() mutable {
+                    try {
+                        if constexpr (std::is_same_v<ReturnType, void>) {
+                            func(largs...);
+                            promise.set_value();
+                        } else {
+                            promise.set_value(func(largs...));
+                        }
+                    } catch (...) {
+                        promise.set_exception(std::current_exception());
+                    }
+                };
+                return std::pair{std::move(task), std::move(future)};
+            } else {
+                /*
+                 * use shared promise here so that we don't break the promise later, as copyable
+                 * function types (like std::function) require a copyable task
+                 *
+                 * with a move only function type we can do the following:
+                 *
+                 * std::promise<ReturnType> promise;
+                 * auto future = promise.get_future();
+                 * auto task = [func = std::move(f), ...largs = std::move(args),
+                                  promise = std::move(promise)]() mutable {...};
+                 */
+                // the allocator is passed on to the promise through uses-allocator construction
+                auto shared_promise = std::allocate_shared<std::promise<ReturnType>>(allocator);
+                auto task = [func = std::move(f), ... largs = std::move(args),
+                             promise = shared_promise]() {
+                    try {
+                        if constexpr (std::is_same_v<ReturnType, void>) {
+                            func(largs...);
+                            promise->set_value();
+                        } else {
+                            promise->set_value(func(largs...));
+                        }
+
+                    } catch (...) {
+                        promise->set_exception(std::current_exception());
+                    }
+                };
+
+                // get the future before enqueuing the task
+                auto future = shared_promise->get_future();
+                return std::pair{std::move(task), std::move(future)};
+            }
+        }
+
+        /**
+         * @brief Wrap a function and its arguments into a task that ignores any result.
+         */
+        template <typename Function, typename... Args>
+        static auto make_detached_task(Function &&func, Args &&...args) {
+            return [f = std::forward<Function>(func),
+                    ... largs = std::forward<Args>(args)]() mutable -> decltype(auto) {
+                // suppress exceptions
+                try {
+                    if constexpr (std::is_same_v<void,
+                                                 std::invoke_result_t<Function &&, Args &&...>>) {
+                        std::invoke(f, largs...);
+                    } else {
+                        // the function returns an argument, but can be ignored
+                        std::ignore = std::invoke(f, largs...);
+                    }
+                } catch (...) {
+                }
+            };
+        }
+
+        /**
+         * @brief Pop the next task of worker @p id from its own queues, highest priority first
+         * unless a lower priority task is due because of priority aging.
+         */
+        std::optional<FunctionType> pop_task(std::size_t id) {
+            auto &item = tasks_[id];
+            if (!priorities_used_.load(std::memory_order_relaxed)) {
+                return item.queues[level_of(priority::normal)].pop_front();
+            }
+
+            if (priority_aging_ != 0 && item.bypassed >= priority_aging_) {
+                // let a waiting lower priority task through, cycling through the lower levels
+                item.bypassed = 0;
+                for (std::size_t i = 1; i < priority_levels; ++i) {
+                    const auto level = item.aged_level;
+                    item.aged_level = level + 1 < priority_levels ? level + 1 : 1;
+                    if (auto task = item.queues[level].pop_front()) return task;
+                }
+            }
+
+            for (std::size_t level = 0; level < priority_levels; ++level) {
+                if (auto task = item.queues[level].pop_front()) {
+                    if (level + 1 < priority_levels) ++item.bypassed;
+                    return task;
+                }
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Steal a task for worker @p thief from the victims it would try next.
+         */
+        std::optional<FunctionType> steal_task(std::size_t thief) {
+            auto task = steal_task(
+                tasks_[thief].victims->next(slot_count_.load(std::memory_order_acquire)), thief);
+            if constexpr (details::collect_statistics) {
+                if (!task) details::worker_counters::add(tasks_[thief].counters.failed_steals, 1);
+            }
+            return task;
+        }
+
+        /**
+         * @brief Steal a task from the first of @p victims that has one, trying all victims for
+         * higher priority tasks first.
+         */
+        std::optional<FunctionType> steal_task(const std::vector<std::size_t> &victims,
+                                               std::size_t thief) {
+            if (!priorities_used_.load(std::memory_order_relaxed)) {
+                return steal_task(victims, thief, level_of(priority::normal));
+            }
+            for (std::size_t level = 0; level < priority_levels; ++level) {
+                if (auto task = steal_task(victims, thief, level)) return task;
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Steal a task of the given priority level from the first of @p victims that has
+         * one.
+         * @details If the queue type supports it, up to half of the victim's tasks are taken at
+         * once and all but the returned one are moved to the queue of worker @p thief.
+         */
+        std::optional<FunctionType> steal_task(const std::vector<std::size_t> &victims,
+                                               std::size_t thief, std::size_t level) {
+            for (const auto victim : victims) {
+                auto &queue = tasks_[victim].queues[level];
+                std::optional<FunctionType> task;
+                // tasks moved to the thief's queue in addition to the returned one
+                std::size_t moved = 0;
+                if constexpr (requires { queue.steal_batch(queue, &moved); }) {
+                    task = queue.steal_batch(tasks_[thief].queues[level], &moved);
+                } else if constexpr (requires { queue.steal_batch(queue); }) {
+                    task = queue.steal_batch(tasks_[thief].queues[level]);
+                } else {
+                    task = queue.steal();
+                }
+                if (task) {
+                    if constexpr (details::collect_statistics) {
+                        const auto stolen = static_cast<std::uint64_t>(moved + 1);
+                        details::worker_counters::add(tasks_[thief].counters.tasks_stolen, stolen);
+                        tasks_[victim].counters.stolen_from.fetch_add(stolen,
+                                                                      std::memory_order_relaxed);
+                    }
+                    return task;
+                }
+            }
+            return std::nullopt;
+        }
+
+        template <typename Queue>
+        static std::size_t queue_depth(const Queue &queue) {
+            if constexpr (requires { queue.size(); }) {
+                return static_cast<std::size_t>(queue.size());
+            } else {
+                return queue.empty() ? 0 : 1;
+            }
+        }
+
+        static constexpr std::size_t priority_levels = 3;
+
+        static constexpr std::size_t level_of(priority task_priority) {
+            return static_cast<std::size_t>(task_priority);
+        }
+
+        std::pmr::memory_resource *task_resource() const {
+            return memory_resource_ != nullptr ? memory_resource_
+                                               : std::pmr::get_default_resource();
+        }
+
+        /**
+         * @brief Convert a task closure to the function type, allocating it from the memory
+         * resource of the pool if the function type can take advantage of that.
+         */
+        template <typename Function>
+        FunctionType make_function(Function &&f) const {
+            if constexpr (details::allocates_closures<FunctionType> &&
+                          !std::same_as<std::remove_cvref_t<Function>, FunctionType>) {
+                if (memory_resource_ != nullptr) {
+                    return details::allocated_closure<std::remove_cvref_t<Function>>(
+                        std::forward<Function>(f), memory_resource_);
+                }
+            }
+            return FunctionType(std::forward<Function>(f));
+        }
+
+        /**
+         * @brief Enqueue a task from a public enqueue function, following the overflow policy if
+         * the pool is bounded.
+         */
+        template <typename Function>
+        void submit(Function &&task, priority task_priority) {
+            if (!admit(1)) {
+                // overflow_policy::caller_runs
+                std::invoke(task);
+                return;
+            }
+            enqueue_task(std::forward<Function>(task), task_priority);
+        }
+
+        void submit_bulk(std::pmr::vector<FunctionType> &tasks) {
+            if (!admit(tasks.size())) {
+                for (auto &task : tasks) std::invoke(std::move(task));
+                return;
+            }
+            enqueue_tasks(tasks);
+        }
+
+        /**
+         * @brief Reserve room for @p count tasks, following the overflow policy of the pool.
+         * @return false if the tasks must run on the calling thread instead.
+         * @throws dp::queue_full_error with overflow_policy::fail.
+         */
+        bool admit(std::size_t count) {
+            if (reserve_queue_slots(count, overflow_)) return true;
+            if (overflow_ == overflow_policy::fail) throw queue_full_error();
+            return false;
+        }
+
+        /**
+         * @brief Reserve room for @p count tasks in a bounded pool. Every task that is pushed to a
+         * queue takes up one slot until it is started or cleared.
+         * @return false if there is no room and @p policy is not overflow_policy::block.
+         */
+        bool reserve_queue_slots(std::size_t count, overflow_policy policy) {
+            if (queue_capacity_ == 0) return true;
+            auto queued = queued_tasks_.load(std::memory_order_seq_cst);
+            while (true) {
+                // a batch larger than the capacity is let through once the queues are empty
+                if (queued == 0 || queued + count <= queue_capacity_) {
+                    if (queued_tasks_.compare_exchange_weak(queued, queued + count,
+                                                            std::memory_order_seq_cst)) {
+                        return true;
+                    }
+                    continue;
+                }
+                if (policy != overflow_policy::block) return false;
+                wait_for_queue_slots(queued);
+                queued = queued_tasks_.load(std::memory_order_seq_cst);
+            }
+        }
+
+        /**
+         * @brief Take up queue slots regardless of the capacity, for tasks that must not be
+         * delayed or rejected.
+         */
+        void force_reserve_queue_slots(std::size_t count) {
+            if (queue_capacity_ != 0) queued_tasks_.fetch_add(count, std::memory_order_seq_cst);
+        }
+
+        void release_queue_slots(std::size_t count) {
+            if (queue_capacity_ == 0 || count == 0) return;
+            queued_tasks_.fetch_sub(count, std::memory_order_seq_cst);
+            // pairs with the increment in wait_for_queue_slots(), either we see the waiting
+            // producer or it sees the new count before it goes to sleep
+            if (blocked_producers_.load(std::memory_order_seq_cst) > 0) {
+                queued_tasks_.notify_all();
+            }
+            details::notify_waiting_workers();
+        }
+
+        /**
+         * @brief Wait until the number of queued tasks changed from @p queued.
+         */
+        void wait_for_queue_slots(std::size_t queued) {
+            // a blocked worker would no longer start tasks, so it runs pending ones instead
+            if (details::help_while_waiting([this, queued] {
+                    return queued_tasks_.load(std::memory_order_seq_cst) != queued;
+                })) {
+                return;
+            }
+            blocked_producers_.fetch_add(1, std::memory_order_seq_cst);
+            queued_tasks_.wait(queued, std::memory_order_seq_cst);
+            blocked_producers_.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief A task that records the time between being enqueued and started, see stats().
+         */
+        template <typename Function>
+        struct timed_task {
+            void operator()() {
+                pool->record_start_latency(enqueued);
+                std::invoke(function);
+            }
+
+            thread_pool *pool;
+            std::chrono::steady_clock::time_point enqueued;
+            Function function;
+        };
+
+        void record_start_latency(std::chrono::steady_clock::time_point enqueued) {
+            if (details::current_worker.pool != this) return;
+            tasks_[details::current_worker.id].counters.record_start_latency(
+                std::chrono::steady_clock::now() - enqueued);
+        }
+
+        /**
+         * @brief Push a task that has been admitted to the queues, sampling it for the start
+         * latency histogram. Tasks that are already a FunctionType, like coroutine resumptions,
+         * are not sampled, as wrapping them in another FunctionType would allocate.
+         * @return false if the task was dropped because the pool has no workers.
+         */
+        template <typename Function>
+        bool enqueue_task(Function &&f, priority task_priority = priority::normal) {
+            using sampled_type = timed_task<std::remove_cvref_t<Function>>;
+            if constexpr (details::collect_statistics &&
+                          !std::same_as<std::remove_cvref_t<Function>, FunctionType> &&
+                          details::can_store_callable<FunctionType, sampled_type>) {
+                if (details::sample_start_latency()) {
+                    return push_task(sampled_type{this, std::chrono::steady_clock::now(),
+                                                  std::forward<Function>(f)},
+                                     task_priority);
+                }
+            }
+            return push_task(std::forward<Function>(f), task_priority);
+        }
+
+        template <typename Function>
+        bool push_task(Function &&f, priority task_priority) {
+            const auto level = level_of(task_priority);
+            if (task_priority != priority::normal &&
+                !priorities_used_.load(std::memory_order_relaxed)) {
+                // from now on workers look at all priority levels. Visible to them at the latest
+                // together with the submitted count below.
+                priorities_used_.store(true, std::memory_order_relaxed);
+            }
+
+            if (details::current_worker.pool == this) {
+                // fast path for tasks enqueued from one of our own workers, push directly to the
+                // worker's own queue without touching the priority queue
+                const auto id = details::current_worker.id;
+                auto task = make_function(std::forward<Function>(f));
+                tasks_[id].submitted.fetch_add(1, std::memory_order_seq_cst);
+                tasks_[id].queues[level].push_back(std::move(task));
+                // this worker is busy, so wake up an idle worker (if any) that can steal the task
+                if (const auto idle = idle_workers_.try_claim_any()) notify_worker(*idle);
+                details::notify_waiting_workers();
+                return true;
+            }
+
+            if (idle_workers_.size() == 0) {
+                // would only be a problem if there are zero threads
+                release_queue_slots(1);
+                return false;
+            }
+
+            auto task = make_function(std::forward<Function>(f));
+
+            // prefer an idle worker, otherwise hand out work in round-robin order. Busy workers
+            // don't need to be signaled as they check for more work before going idle.
+            const auto idle = idle_workers_.try_claim_any();
+            const auto i = idle.value_or(idle_workers_.next());
+
+            // count the task as submitted before it can be taken from the queue and before the
+            // check for idle workers below, see the worker loop.
+            tasks_[i].submitted.fetch_add(1, std::memory_order_seq_cst);
+
+            // assign work
+            tasks_[i].queues[level].push_back(std::move(task));
+            notify_after_submit(idle, i);
+            details::notify_waiting_workers();
+            return true;
+        }
+
+        /**
+         * @brief Wake up the worker claimed for a new task or, if all workers were busy, a worker
+         * that went idle before it could see the task.
+         */
+        void notify_after_submit(std::optional<std::size_t> idle, std::size_t worker) {
+            if (idle) {
+                notify_worker(worker);
+            } else if (const auto late = idle_workers_.try_claim_any()) {
+                notify_worker(*late);
+            }
+        }
+
+        /**
+         * @brief Wake up a worker claimed from the idle set, or another one if it was retired in
+         * the meantime.
+         * @details A retired worker may exit without seeing the task that was just pushed to its
+         * queue, the worker woken instead steals it. Tasks pushed to a retired worker that was
+         * still seen as active are taken care of by resize_workers().
+         */
+        void notify_worker(std::size_t id) {
+            tasks_[id].signal.notify();
+            if (id >= worker_count_.load(std::memory_order_seq_cst)) {
+                if (const auto other = idle_workers_.try_claim_any()) {
+                    tasks_[*other].signal.notify();
+                }
+            }
+        }
+
+        /**
+         * @brief Enqueue multiple tasks, split into one batch per worker.
+         */
+        void enqueue_tasks(std::pmr::vector<FunctionType> &tasks) {
+            const auto count = tasks.size();
+            if (count == 0 || idle_workers_.size() == 0) {
+                release_queue_slots(count);
+                return;
+            }
+
+            if (details::current_worker.pool == this) {
+                // see enqueue_task()
+                const auto id = details::current_worker.id;
+                tasks_[id].submitted.fetch_add(static_cast<std::int64_t>(count),
+                                               std::memory_order_seq_cst);
+                push_batch(tasks_[id].queues[level_of(priority::normal)], tasks.begin(),
+                           tasks.end());
+                // wake up as many idle workers as there are new tasks
+                for (std::size_t i = 0; i < count; ++i) {
+                    const auto idle = idle_workers_.try_claim_any();
+                    if (!idle) break;
+                    notify_worker(*idle);
+                }
+                details::notify_waiting_workers();
+                return;
+            }
+
+            // only use as many batches (and wake as many workers) as needed
+            const auto batch_count = std::min(count, idle_workers_.size());
+            auto first = tasks.begin();
+            for (std::size_t batch = 0; batch < batch_count; ++batch) {
+                const auto batch_size = count / batch_count + (batch < count % batch_count ? 1 : 0);
+                const auto last = first + static_cast<std::ptrdiff_t>(batch_size);
+
+                const auto idle = idle_workers_.try_claim_any();
+                const auto i = idle.value_or(idle_workers_.next());
+                tasks_[i].submitted.fetch_add(static_cast<std::int64_t>(batch_size),
+                                              std::memory_order_seq_cst);
+                push_batch(tasks_[i].queues[level_of(priority::normal)], first, last);
+                notify_after_submit(idle, i);
+
+                first = last;
+            }
+            details::notify_waiting_workers();
+        }
+
+        template <typename Iterator>
+        static void push_batch(QueueType &queue, Iterator first, Iterator last) {
+            auto batch = std::ranges::subrange(std::make_move_iterator(first),
+                                               std::make_move_iterator(last));
+            if constexpr (requires { queue.append_range(batch); }) {
+                queue.append_range(batch);
+            } else {
+                for (auto &&task : batch) queue.push_back(std::move(task));
+            }
+        }
+
+        // every worker gets its own cache lines so that pushing to or waking up one worker does
+        // not invalidate the state of its neighbours
+        struct alignas(details::cache_line_size) task_item {
+            task_item() = default;
+            explicit task_item(std::pmr::memory_resource *resource)
+                : task_item(resource, std::make_index_sequence<priority_levels>{}) {}
+
+            template <std::size_t... Levels>
+            task_item(std::pmr::memory_resource *resource, std::index_sequence<Levels...>)
+                : queues{((void)Levels, QueueType(resource))...} {}
+
+            // one queue per priority, highest priority first
+            std::array<QueueType, priority_levels> queues;
+            // written by producers waking up the worker, keep it away from the queue's lock
+            alignas(details::cache_line_size) details::worker_signal signal{};
+            // number of tasks pushed to this queue, written by producers
+            std::atomic_int_fast64_t submitted{0};
+            // number of tasks started and completed by this worker (from any queue), only ever
+            // written by the worker itself
+            alignas(details::cache_line_size) std::atomic_int_fast64_t started{0};
+            std::atomic_int_fast64_t completed{0};
+            // when the worker went idle (steady clock ticks) or 0 while it is busy, only kept up
+            // to date with autoscaling
+            std::atomic<std::chrono::steady_clock::rep> idle_since{0};
+            // priority aging state, only used by the worker itself
+            std::uint32_t bypassed{0};
+            std::size_t aged_level{1};
+            // created by the worker when it starts
+            std::optional<details::victim_order> victims{};
+            // whether the worker was pinned to its CPUs, see worker_cpus()
+            std::atomic_bool pinned{false};
+            // see stats()
+            details::worker_counters counters{};
+        };
+
+        /**
+         * @brief Invoke a task that worker @p id has taken from a queue.
+         */
+        void run_task(std::size_t id, FunctionType &task) {
+            // the task is no longer unassigned as it is now going to be executed
+            increment(tasks_[id].started);
+            release_queue_slots(1);
+            std::invoke(std::move(task));
+            // the above task can push more work onto the pool, so we only count it as completed
+            // once it has been executed because now it's no longer "in flight"
+            increment(tasks_[id].completed);
+        }
+
+        /**
+         * @brief Run one pending task on worker @p id while it waits for something, see
+         * details::help_while_waiting().
+         */
+        static bool run_pending_task(void *pool, std::size_t id) {
+            auto &self = *static_cast<thread_pool *>(pool);
+            auto task = self.pop_task(id);
+            if (!task) task = self.steal_task(id);
+            if (!task) return false;
+            self.run_task(id, *task);
+            // other waiting workers may wait for the tasks to complete, see wait_for_tasks()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            details::notify_waiting_workers();
+            return true;
+        }
+
+        static bool has_pending_tasks(const void *pool) {
+            return static_cast<const thread_pool *>(pool)->has_unassigned_tasks();
+        }
+
+        /**
+         * @brief Increment a counter that only the calling worker writes to, which doesn't need
+         * a read-modify-write.
+         */
+        static void increment(std::atomic_int_fast64_t &counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief The number of tasks that were submitted, but not started yet.
+         * @details The per-worker counters are summed up, reading the started counts first: a task
+         * is always submitted before it is started, so the sum never misses a task whose
+         * submission is visible to the caller. Retired workers are included, as they may still
+         * have tasks in their queues.
+         */
+        [[nodiscard]] std::int_fast64_t unassigned_tasks() const {
+            std::int_fast64_t count = 0;
+            for (const auto &item : used_slots()) {
+                count -= item.started.load(std::memory_order_seq_cst);
+            }
+            for (const auto &item : used_slots()) {
+                count += item.submitted.load(std::memory_order_seq_cst);
+            }
+            return count;
+        }
+
+        [[nodiscard]] bool has_unassigned_tasks() const { return unassigned_tasks() > 0; }
+
+        /**
+         * @brief The number of tasks that were submitted, but not completed yet. See
+         * has_unassigned_tasks().
+         */
+        [[nodiscard]] std::int_fast64_t in_flight_tasks() const {
+            std::int_fast64_t count = 0;
+            for (const auto &item : used_slots()) {
+                count -= item.completed.load(std::memory_order_seq_cst);
+            }
+            for (const auto &item : used_slots()) {
+                count += item.submitted.load(std::memory_order_seq_cst);
+            }
+            return count;
+        }
+
+        [[nodiscard]] bool has_in_flight_tasks() const { return in_flight_tasks() > 0; }
+
+        /**
+         * @brief The slots of all workers that were ever started.
+         */
+        auto used_slots() const {
+            return tasks_ | std::views::take(slot_count_.load(std::memory_order_acquire));
+        }
+        auto used_slots() {
+            return tasks_ | std::views::take(slot_count_.load(std::memory_order_acquire));
+        }
+
+        static std::size_t max_workers(const thread_pool_options &options) {
+            // at least one slot, so that a pool without workers can still be resized
+            return std::max({1U, options.thread_count, options.max_thread_count,
+                             options.autoscaling.enabled ? options.autoscaling.max_threads : 0U});
+        }
+
+        static std::chrono::steady_clock::rep now_ticks() {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        /**
+         * @brief Start a worker with the next id. Requires resize_mutex_ (or the constructor).
+         * @return false if the thread could not be started.
+         */
+        bool start_worker() {
+            const auto id = threads_.size();
+            try {
+                threads_.emplace_back(
+                    [this, id](const std::stop_token &stop_tok) { run_worker(id, stop_tok); });
+            } catch (...) {
+                return false;
+            }
+            // the slot is part of the victim lists and the task counts from now on
+            if (slot_count_.load(std::memory_order_relaxed) <= id) {
+                slot_count_.store(id + 1, std::memory_order_seq_cst);
+            }
+            // the new worker can now be handed tasks
+            idle_workers_.add_worker(id);
+            worker_count_.store(id + 1, std::memory_order_seq_cst);
+            return true;
+        }
+
+        /**
+         * @brief Start or retire workers until there are @p target of them. Requires
+         * resize_mutex_.
+         */
+        void resize_workers(std::size_t target) {
+            while (threads_.size() < target) {
+                if (!start_worker()) return;
+            }
+            if (threads_.size() == target) return;
+
+            while (threads_.size() > target) {
+                const auto id = threads_.size() - 1;
+                // producers that see the new count wake another worker for tasks they pushed to
+                // this one, see notify_worker()
+                worker_count_.store(id, std::memory_order_seq_cst);
+                idle_workers_.remove_worker(id);
+                threads_.back().request_stop();
+                tasks_[id].signal.notify();
+                threads_.back().join();
+                threads_.pop_back();
+            }
+
+            // producers that still saw the retired workers as active may have pushed tasks to
+            // them after they exited, make sure a remaining worker is awake to steal them
+            if (has_unassigned_tasks()) {
+                if (const auto idle = idle_workers_.try_claim_any()) {
+                    tasks_[*idle].signal.notify();
+                }
+            }
+        }
+
+        void run_worker(std::size_t id, const std::stop_token &stop_tok) {
+            // mark this thread as a worker of this pool
+            details::current_worker = {this, id, &thread_pool::run_pending_task,
+                                       &thread_pool::has_pending_tasks, &idle_strategy_};
+            if (!worker_cpus_.empty()) {
+                tasks_[id].pinned.store(details::set_current_thread_cpus(worker_cpus_[id]),
+                                        std::memory_order_release);
+            }
+            tasks_[id].victims.emplace(victim_selector_, id, 0x9E3779B97F4A7C15ULL * (id + 1));
+
+            // invoke the init function on the thread
+            try {
+                std::invoke(init_, id);
+            } catch (...) {
+                // suppress exceptions
+            }
+
+            do {
+                std::chrono::steady_clock::time_point parked_since{};
+                if constexpr (details::collect_statistics) {
+                    parked_since = std::chrono::steady_clock::now();
+                }
+                // wait until signaled
+                tasks_[id].signal.wait(idle_strategy_);
+                std::chrono::steady_clock::time_point woken{};
+                if constexpr (details::collect_statistics) {
+                    woken = std::chrono::steady_clock::now();
+                    tasks_[id].counters.add_parked(woken - parked_since);
+                }
+                if (victim_selector_.policy() == victim_selection::topology) {
+                    victim_selector_.update_cpu(id, details::current_cpu());
+                }
+                // we may have been woken up without being claimed, so make sure that we are no
+                // longer marked as idle
+                std::ignore = idle_workers_.try_claim(id);
+                if (autoscaling_.enabled) {
+                    tasks_[id].idle_since.store(0, std::memory_order_relaxed);
+                }
+
+                // a retired worker exits after its current task, the others steal its queue
+                while (!stop_tok.stop_requested()) {
+                    // invoke the task
+                    if (auto task = pop_task(id)) {
+                        run_task(id, *task);
+                        continue;
+                    }
+
+                    // try to steal a task, stop stealing once we have invoked a stolen task
+                    if (auto task = steal_task(id)) run_task(id, *task);
+                    // check if there are any unassigned tasks before rotating to the front and
+                    // waiting for more work
+                    if (!has_unassigned_tasks()) break;
+                }
+
+                if constexpr (details::collect_statistics) {
+                    tasks_[id].counters.add_busy(std::chrono::steady_clock::now() - woken);
+                }
+                if (autoscaling_.enabled) {
+                    tasks_[id].idle_since.store(now_ticks(), std::memory_order_relaxed);
+                }
+                idle_workers_.mark_idle(id);
+                // a task could have been enqueued after we last checked, but before we were
+                // marked as idle. If so, claim ourselves so we don't miss it.
+                if (has_unassigned_tasks() && idle_workers_.try_claim(id)) {
+                    tasks_[id].signal.notify();
+                }
+
+                // check if all tasks are completed and wake up wait_for_tasks(). The fence makes
+                // sure that of several workers completing the last tasks at the same time, at
+                // least one sees all of them completed.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!has_in_flight_tasks()) {
+                    tasks_completed_.fetch_add(1, std::memory_order_release);
+                    tasks_completed_.notify_all();
+                }
+                // workers of this pool may wait for the tasks, see wait_for_tasks()
+                details::notify_waiting_workers();
+
+            } while (!stop_tok.stop_requested());
+
+            // a retired worker must no longer be handed out
+            std::ignore = idle_workers_.try_claim(id);
+            tasks_[id].idle_since.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Periodically adjust the number of workers, see dp::autoscaling_policy.
+         */
+        void autoscale(const std::stop_token &stop_tok) {
+            std::mutex mutex;
+            std::condition_variable_any wakeup;
+            std::unique_lock lock(mutex);
+            while (!stop_tok.stop_requested()) {
+                // returns early once stop is requested
+                std::ignore = wakeup.wait_for(lock, stop_tok, autoscaling_.interval,
+                                              [] { return false; });
+                if (stop_tok.stop_requested()) return;
+
+                std::scoped_lock resize_lock(resize_mutex_);
+                const auto target = autoscale_target();
+                if (target != threads_.size()) resize_workers(target);
+            }
+        }
+
+        /**
+         * @brief The number of workers the autoscaler aims for. Requires resize_mutex_.
+         */
+        [[nodiscard]] std::size_t autoscale_target() const {
+            const auto active = threads_.size();
+            // normalized by the constructor
+            const std::size_t min_count = autoscaling_.min_threads;
+            const std::size_t max_count = autoscaling_.max_threads;
+            const auto depth = std::max<std::size_t>(autoscaling_.queue_depth, 1);
+
+            const auto unassigned = static_cast<std::size_t>(std::max<std::int_fast64_t>(
+                unassigned_tasks(), 0));
+            if (unassigned > depth * active) {
+                // enough workers for the waiting tasks at once, bursts need more than one step
+                return std::min(std::max((unassigned + depth - 1) / depth, active + 1), max_count);
+            }
+
+            const auto now = now_ticks();
+            const auto idle_time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       autoscaling_.idle_time)
+                                       .count();
+            std::size_t long_idle = 0;
+            for (std::size_t id = 0; id < active; ++id) {
+                const auto since = tasks_[id].idle_since.load(std::memory_order_relaxed);
+                if (since != 0 && now - since >= idle_time) ++long_idle;
+            }
+            return std::clamp(active - long_idle, min_count, max_count);
+        }
 
         std::vector<ThreadType> threads_;
+        // one slot per potential worker, never resized so that workers can access it without
+        // locking
         std::deque<task_item> tasks_;
-        dp::thread_safe_queue<std::size_t> priority_queue_;
-        // guarantee these get zero-initialized
-        std::atomic_int_fast64_t unassigned_tasks_{0}, in_flight_tasks_{0};
-        std::atomic_bool threads_complete_signal_{false};
+        details::idle_worker_tracker idle_workers_;
+        // number of running workers, ids are always [0, worker_count_)
+        std::atomic_size_t worker_count_{0};
+        // number of slots that were ever used by a worker, only grows
+        std::atomic_size_t slot_count_{0};
+        // incremented whenever a worker finds all tasks completed, see wait_for_tasks()
+        alignas(details::cache_line_size) std::atomic<std::uint32_t> tasks_completed_{0};
+        // number of tasks calling wait_for_tasks() from a worker of this pool
+        std::atomic_int_fast64_t waiting_tasks_{0};
+        // read-only after construction
+        alignas(details::cache_line_size) std::pmr::memory_resource *memory_resource_{nullptr};
+        idle_strategy idle_strategy_{};
+        details::victim_selector victim_selector_;
+        // the CPU set of every worker, empty if workers are not pinned
+        std::vector<std::vector<int>> worker_cpus_;
+        std::uint32_t priority_aging_{0};
+        // whether any task with a priority other than normal was enqueued
+        std::atomic_bool priorities_used_{false};
+        std::function<void(std::size_t)> init_;
+        autoscaling_policy autoscaling_;
+        // serializes resize() and the autoscaler
+        std::mutex resize_mutex_;
+        std::optional<ThreadType> autoscaler_;
+
+        // canceled timers that are still in the timer wheel, shared with the timer states as
+        // they can be canceled after the pool is gone. Can briefly be negative, see
+        // run_timers().
+        using canceled_timer_count = std::shared_ptr<std::atomic_int_fast64_t>;
+
+        /**
+         * @brief Shared state of a timer created with enqueue_at().
+         * @details The task is claimed once, either by the timer thread when the timer expires or
+         * by cancel(), which destroys it right away instead of keeping its captures alive until
+         * the deadline.
+         */
+        struct oneshot_timer : details::timer_state {
+            explicit oneshot_timer(canceled_timer_count canceled_count)
+                : canceled_timers(std::move(canceled_count)) {}
+
+            std::optional<FunctionType> claim() {
+                if (claimed.test_and_set(std::memory_order_acq_rel)) return std::nullopt;
+                return std::exchange(task, std::nullopt);
+            }
+
+            std::optional<FunctionType> task;
+            std::atomic_flag claimed{};
+            canceled_timer_count canceled_timers;
+
+          protected:
+            void on_cancel() noexcept override {
+                // nothing to do if the timer expired already
+                if (claim()) canceled_timers->fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * @brief Shared state of a timer created with enqueue_every().
+         */
+        struct periodic_timer : details::timer_state {
+            periodic_timer(canceled_timer_count canceled_count, FunctionType function,
+                           std::uint64_t period_ticks)
+                : job(std::move(function)),
+                  period(period_ticks),
+                  canceled_timers(std::move(canceled_count)) {}
+
+            void run() {
+                if (!canceled.load(std::memory_order_relaxed)) job();
+                running.clear(std::memory_order_release);
+            }
+
+            FunctionType job;
+            std::uint64_t period;
+            // set while a run is queued or in progress
+            std::atomic_flag running{};
+            canceled_timer_count canceled_timers;
+
+          protected:
+            // a periodic timer stays in the wheel until its next run is due
+            void on_cancel() noexcept override {
+                canceled_timers->fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        struct timer_entry {
+            std::shared_ptr<details::timer_state> state;
+            std::shared_ptr<oneshot_timer> oneshot;
+            std::shared_ptr<periodic_timer> periodic;
+        };
+
+        /**
+         * @brief The first tick of the timer wheel at or after @p time.
+         */
+        template <typename Clock, typename Duration>
+        std::uint64_t deadline_tick(std::chrono::time_point<Clock, Duration> time) const {
+            std::chrono::steady_clock::time_point steady_time;
+            if constexpr (std::same_as<Clock, std::chrono::steady_clock>) {
+                steady_time =
+                    std::chrono::time_point_cast<std::chrono::steady_clock::duration>(time);
+            } else {
+                steady_time = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  time - Clock::now());
+            }
+            if (steady_time <= timer_epoch_) return 0;
+            const auto elapsed = steady_time - timer_epoch_;
+            return static_cast<std::uint64_t>((elapsed + timer_resolution_ -
+                                               std::chrono::steady_clock::duration{1}) /
+                                              timer_resolution_);
+        }
+
+        /**
+         * @brief The last tick of the timer wheel that has started at @p time.
+         */
+        std::uint64_t current_tick(std::chrono::steady_clock::time_point time) const {
+            return static_cast<std::uint64_t>((time - timer_epoch_) / timer_resolution_);
+        }
+
+        void add_timer(std::uint64_t deadline, timer_entry timer) {
+            std::scoped_lock lock(timer_mutex_);
+            if (!timer_thread_) {
+                timer_thread_.emplace(
+                    [this](const std::stop_token &stop_tok) { run_timers(stop_tok); });
+            }
+            timers_.insert(deadline, std::move(timer));
+            // drop canceled timers once they make up most of the wheel, so that timers which are
+            // usually canceled long before their deadline, like timeouts, don't pile up
+            const auto canceled = canceled_timers_->load(std::memory_order_relaxed);
+            if (canceled >= 64 && static_cast<std::size_t>(canceled) * 2 > timers_.size()) {
+                const auto removed = timers_.erase_if([](const timer_entry &entry) {
+                    return entry.state->canceled.load(std::memory_order_relaxed);
+                });
+                canceled_timers_->fetch_sub(static_cast<std::int_fast64_t>(removed),
+                                            std::memory_order_relaxed);
+            }
+            // wake up the timer thread if it sleeps past the new deadline
+            if (deadline < timer_wake_tick_) {
+                timer_wake_tick_ = deadline;
+                timers_changed_ = true;
+                timer_wakeup_.notify_one();
+            }
+        }
+
+        /**
+         * @brief Loop of the timer thread, hands expired timers to the workers and sleeps until
+         * the next deadline in between.
+         */
+        void run_timers(const std::stop_token &stop_tok) {
+            using expired_timer = typename details::timer_wheel<timer_entry>::entry;
+            std::vector<expired_timer> expired;
+            std::pmr::vector<FunctionType> due(task_resource());
+
+            std::unique_lock lock(timer_mutex_);
+            while (!stop_tok.stop_requested()) {
+                const auto now = current_tick(std::chrono::steady_clock::now());
+                timers_.advance(now, expired);
+                if (!expired.empty()) {
+                    for (auto &[deadline, timer] : expired) {
+                        if (timer.oneshot) {
+                            if (auto task = timer.oneshot->claim()) {
+                                due.push_back(std::move(*task));
+                            } else {
+                                // claimed by cancel(), which counts it before or after this
+                                canceled_timers_->fetch_sub(1, std::memory_order_relaxed);
+                            }
+                            continue;
+                        }
+                        if (timer.state->canceled.load(std::memory_order_relaxed)) {
+                            canceled_timers_->fetch_sub(1, std::memory_order_relaxed);
+                            continue;
+                        }
+                        if (!timer.periodic->running.test_and_set(std::memory_order_acquire)) {
+                            due.push_back(
+                                make_function([periodic = timer.periodic] { periodic->run(); }));
+                        }
+                        // fixed rate, periods missed while the pool was overloaded are skipped
+                        const auto period = timer.periodic->period;
+                        timers_.insert(deadline + period * ((now - deadline) / period + 1),
+                                       std::move(timer));
+                    }
+                    expired.clear();
+
+                    lock.unlock();
+                    // one batch per worker instead of one queue operation and wake-up per timer.
+                    // The timer thread is never blocked by the overflow policy.
+                    force_reserve_queue_slots(due.size());
+                    enqueue_tasks(due);
+                    due.clear();
+                    lock.lock();
+                    continue;
+                }
+
+                const auto next = timers_.next_tick();
+                timer_wake_tick_ = next.value_or(std::numeric_limits<std::uint64_t>::max());
+                timers_changed_ = false;
+                const auto changed = [this] { return timers_changed_; };
+                if (next) {
+                    std::ignore = timer_wakeup_.wait_until(
+                        lock, stop_tok,
+                        timer_epoch_ + static_cast<std::chrono::steady_clock::rep>(*next) *
+                                           timer_resolution_,
+                        changed);
+                } else {
+                    std::ignore = timer_wakeup_.wait(lock, stop_tok, changed);
+                }
+            }
+        }
+
+        // delayed and periodic tasks, see enqueue_at()
+        std::chrono::steady_clock::time_point timer_epoch_;
+        std::chrono::steady_clock::duration timer_resolution_;
+        mutable std::mutex timer_mutex_;
+        std::condition_variable_any timer_wakeup_;
+        details::timer_wheel<timer_entry> timers_;
+        canceled_timer_count canceled_timers_ = std::make_shared<std::atomic_int_fast64_t>(0);
+        // the tick the timer thread sleeps until
+        std::uint64_t timer_wake_tick_{std::numeric_limits<std::uint64_t>::max()};
+        bool timers_changed_{false};
+        std::optional<ThreadType> timer_thread_;
+
+        // bounded queues, see thread_pool_options::queue_capacity
+        std::size_t queue_capacity_;
+        overflow_policy overflow_;
+        // tasks that were pushed to a queue and not started or cleared yet, only counted if the
+        // pool is bounded
+        alignas(details::cache_line_size) std::atomic_size_t queued_tasks_{0};
+        std::atomic_size_t blocked_producers_{0};
+        // cancels tasks that take the token of the pool
+        std::stop_source stop_source_;
     };
 
     /**
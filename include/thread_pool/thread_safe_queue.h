@@ -3,8 +3,11 @@
 #include <algorithm>
 #include <concepts>
 #include <deque>
+#include <iterator>
+#include <memory_resource>
 #include <mutex>
 #include <optional>
+#include <ranges>
 
 namespace dp {
     /**
@@ -25,15 +28,32 @@ namespace dp {
     class thread_safe_queue {
       public:
         using value_type = T;
-        using size_type = typename std::deque<T>::size_type;
+        using size_type = typename std::pmr::deque<T>::size_type;
 
         thread_safe_queue() = default;
 
+        /**
+         * @brief Construct a queue that allocates its storage from the given memory resource.
+         */
+        explicit thread_safe_queue(std::pmr::memory_resource* resource) : data_(resource) {}
+
         void push_back(T&& value) {
             std::scoped_lock lock(mutex_);
             data_.push_back(std::forward<T>(value));
         }
 
+        /**
+         * @brief Push multiple values to the back of the queue while holding the lock once.
+         */
+        template <std::ranges::input_range Range>
+            requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+        void append_range(Range&& values) {
+            std::scoped_lock lock(mutex_);
+            for (auto&& value : values) {
+                data_.push_back(std::forward<decltype(value)>(value));
+            }
+        }
+
         void push_front(T&& value) {
             std::scoped_lock lock(mutex_);
             data_.push_front(std::forward<T>(value));
@@ -44,6 +64,11 @@ namespace dp {
             return data_.empty();
         }
 
+        [[nodiscard]] size_type size() const {
+            std::scoped_lock lock(mutex_);
+            return data_.size();
+        }
+
         size_type clear() {
             std::scoped_lock lock(mutex_);
             auto size = data_.size();
@@ -79,6 +104,31 @@ namespace dp {
             return back;
         }
 
+        /**
+         * @brief Steal up to half of the items from the back of the queue at once.
+         * @details The oldest of the stolen items is returned and the others are appended to
+         * @p destination in order. Both queues are locked at the same time, using a deadlock
+         * avoidance algorithm.
+         * @param destination The queue that receives the items that are not returned.
+         * @param moved If not null, set to the number of items appended to @p destination.
+         */
+        [[nodiscard]] std::optional<T> steal_batch(thread_safe_queue& destination,
+                                                   std::size_t* moved = nullptr) {
+            if (moved != nullptr) *moved = 0;
+            if (&destination == this) return steal();
+
+            std::scoped_lock lock(mutex_, destination.mutex_);
+            if (data_.empty()) return std::nullopt;
+
+            const auto count = static_cast<std::ptrdiff_t>((data_.size() + 1) / 2);
+            const auto first = data_.end() - count;
+            std::optional<T> stolen = std::move(*first);
+            std::move(std::next(first), data_.end(), std::back_inserter(destination.data_));
+            data_.erase(first, data_.end());
+            if (moved != nullptr) *moved = static_cast<std::size_t>(count - 1);
+            return stolen;
+        }
+
         void rotate_to_front(const T& item) {
             std::scoped_lock lock(mutex_);
             auto iter = std::find(data_.begin(), data_.end(), item);
@@ -104,7 +154,7 @@ namespace dp {
         }
 
       private:
-        std::deque<T> data_{};
+        std::pmr::deque<T> data_{};
         mutable Lock mutex_{};
     };
 }  // namespace dp
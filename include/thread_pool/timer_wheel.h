@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace dp {
+    namespace details {
+        /**
+         * @brief Shared state of a timer, see dp::timer_handle.
+         */
+        struct timer_state {
+            virtual ~timer_state() = default;
+
+            /**
+             * @brief Mark the timer as canceled, calling on_cancel() the first time.
+             */
+            void cancel() noexcept {
+                if (!canceled.exchange(true, std::memory_order_relaxed)) on_cancel();
+            }
+
+            std::atomic_bool canceled{false};
+
+          protected:
+            /**
+             * @brief Lets the owner of the timer release its resources right away instead of at
+             * the deadline.
+             */
+            virtual void on_cancel() noexcept {}
+        };
+
+        /**
+         * @brief Hierarchical timer wheel, in ticks of a fixed resolution.
+         * @details Each level has 64 slots, a slot of level l covering 64^l ticks. A timer goes
+         * to the level of the highest 6 bit group in which its deadline differs from the current
+         * tick, and moves down one or more levels when the current tick reaches the start of its
+         * slot. Inserting and expiring a timer is O(1) regardless of how many timers are pending
+         * and a bitmap of the non-empty slots per level lets advance() jump over empty stretches
+         * instead of visiting every tick. Deadlines beyond the top level are kept in an overflow
+         * list that is checked once per top level revolution. Not thread safe.
+         */
+        template <typename T>
+        class timer_wheel {
+            static constexpr std::size_t slot_bits = 6;
+            static constexpr std::size_t slot_count = std::size_t{1} << slot_bits;
+            static constexpr std::size_t level_count = 6;
+            // ticks covered by all levels, later deadlines overflow
+            static constexpr std::size_t overflow_shift = slot_bits * level_count;
+
+          public:
+            struct entry {
+                std::uint64_t deadline;
+                T value;
+            };
+
+            explicit timer_wheel(std::uint64_t start_tick = 0) : current_(start_tick) {}
+
+            /**
+             * @brief The first tick that has not been processed by advance() yet.
+             */
+            [[nodiscard]] std::uint64_t current() const { return current_; }
+
+            [[nodiscard]] std::size_t size() const { return size_; }
+            [[nodiscard]] bool empty() const { return size_ == 0; }
+
+            /**
+             * @brief Add a timer that expires at @p deadline, or at the current tick if the
+             * deadline has already passed.
+             */
+            void insert(std::uint64_t deadline, T value) {
+                place(entry{std::max(deadline, current_), std::move(value)});
+                ++size_;
+            }
+
+            /**
+             * @brief Process all ticks up to and including @p now, appending the expired timers
+             * to @p expired in deadline order.
+             */
+            void advance(std::uint64_t now, std::vector<entry> &expired) {
+                for (auto tick = next_tick(); tick && *tick <= now; tick = next_tick()) {
+                    current_ = *tick;
+                    // move timers down from the levels whose slot starts at this tick, highest
+                    // level first as its timers may land in a slot of a lower level that starts
+                    // here as well
+                    if (low_bits(current_, overflow_shift) == 0 && !overflow_.empty()) {
+                        cascade(overflow_);
+                    }
+                    for (auto level = level_count - 1; level > 0; --level) {
+                        const auto shift = level * slot_bits;
+                        if (low_bits(current_, shift) != 0) continue;
+                        const auto slot = index_of(current_, shift);
+                        if ((occupied_[level] & bit(slot)) == 0) continue;
+                        occupied_[level] &= ~bit(slot);
+                        cascade(slots_[level][slot]);
+                    }
+
+                    const auto slot = index_of(current_, 0);
+                    if ((occupied_[0] & bit(slot)) != 0) {
+                        occupied_[0] &= ~bit(slot);
+                        auto &due = slots_[0][slot];
+                        size_ -= due.size();
+                        std::ranges::move(due, std::back_inserter(expired));
+                        due.clear();
+                    }
+                    ++current_;
+                }
+                current_ = std::max(current_, now + 1);
+            }
+
+            /**
+             * @brief Remove all timers for which @p predicate returns true.
+             * @return The number of removed timers.
+             */
+            template <typename Predicate>
+            std::size_t erase_if(Predicate predicate) {
+                const auto before = size_;
+                for (std::size_t level = 0; level < level_count; ++level) {
+                    for (std::size_t slot = 0; slot < slot_count; ++slot) {
+                        auto &timers = slots_[level][slot];
+                        if (timers.empty()) continue;
+                        size_ -= std::erase_if(timers, [&predicate](entry &timer) {
+                            return predicate(timer.value);
+                        });
+                        if (timers.empty()) occupied_[level] &= ~bit(slot);
+                    }
+                }
+                size_ -= std::erase_if(
+                    overflow_, [&predicate](entry &timer) { return predicate(timer.value); });
+                return before - size_;
+            }
+
+            /**
+             * @brief The next tick at which advance() has something to do: either timers expire
+             * or they move down to a lower level. std::nullopt if there are no timers.
+             */
+            [[nodiscard]] std::optional<std::uint64_t> next_tick() const {
+                std::optional<std::uint64_t> next;
+                const auto earliest = [&next](std::uint64_t tick) {
+                    if (!next || tick < *next) next = tick;
+                };
+
+                for (std::size_t level = 0; level < level_count; ++level) {
+                    const auto shift = level * slot_bits;
+                    // slots before the current one were processed already. The current slot of a
+                    // higher level is only pending if we are exactly at its start.
+                    auto first = index_of(current_, shift);
+                    if (level > 0 && low_bits(current_, shift) != 0) ++first;
+                    const auto pending = first < slot_count ? occupied_[level] & ~(bit(first) - 1)
+                                                            : std::uint64_t{0};
+                    if (pending == 0) continue;
+
+                    const auto block = current_ & ~(bit(shift + slot_bits) - 1);
+                    earliest(block |
+                             (static_cast<std::uint64_t>(std::countr_zero(pending)) << shift));
+                }
+                if (!overflow_.empty()) {
+                    earliest(((current_ >> overflow_shift) +
+                              (low_bits(current_, overflow_shift) != 0 ? 1 : 0))
+                             << overflow_shift);
+                }
+                return next;
+            }
+
+          private:
+            static constexpr std::uint64_t bit(std::size_t index) {
+                return index < 64 ? std::uint64_t{1} << index : 0;
+            }
+            static constexpr std::uint64_t low_bits(std::uint64_t tick, std::size_t count) {
+                return tick & (bit(count) - 1);
+            }
+            static constexpr std::size_t index_of(std::uint64_t tick, std::size_t shift) {
+                return static_cast<std::size_t>((tick >> shift) & (slot_count - 1));
+            }
+
+            void place(entry &&timer) {
+                const auto level =
+                    timer.deadline == current_
+                        ? std::size_t{0}
+                        : static_cast<std::size_t>(std::bit_width(timer.deadline ^ current_) - 1) /
+                              slot_bits;
+                if (level >= level_count) {
+                    overflow_.push_back(std::move(timer));
+                    return;
+                }
+                const auto slot = index_of(timer.deadline, level * slot_bits);
+                occupied_[level] |= bit(slot);
+                slots_[level][slot].push_back(std::move(timer));
+            }
+
+            void cascade(std::vector<entry> &timers) {
+                auto moving = std::exchange(timers, {});
+                for (auto &timer : moving) place(std::move(timer));
+                // keep the allocation if the slot is still empty
+                if (timers.empty()) {
+                    moving.clear();
+                    timers = std::move(moving);
+                }
+            }
+
+            std::uint64_t current_;
+            std::size_t size_{0};
+            std::array<std::uint64_t, level_count> occupied_{};
+            std::array<std::array<std::vector<entry>, slot_count>, level_count> slots_{};
+            std::vector<entry> overflow_{};
+        };
+    }  // namespace details
+
+    /**
+     * @brief Handle to a timer created with dp::thread_pool::enqueue_after(),
+     * dp::thread_pool::enqueue_at() or dp::thread_pool::enqueue_every().
+     * @details Copies refer to the same timer. Dropping the handle does not cancel the timer.
+     */
+    class timer_handle {
+      public:
+        timer_handle() = default;
+        explicit timer_handle(std::shared_ptr<details::timer_state> state)
+            : state_(std::move(state)) {}
+
+        /**
+         * @brief Whether the handle refers to a timer.
+         */
+        [[nodiscard]] bool valid() const noexcept { return state_ != nullptr; }
+
+        /**
+         * @brief Stop the timer. Runs that have not started yet are skipped, a run that is in
+         * progress completes. The task of a one-shot timer that has not expired yet is destroyed
+         * right away.
+         */
+        void cancel() const noexcept {
+            if (state_) state_->cancel();
+        }
+
+        [[nodiscard]] bool is_canceled() const noexcept {
+            return state_ && state_->canceled.load(std::memory_order_relaxed);
+        }
+
+      private:
+        std::shared_ptr<details::timer_state> state_;
+    };
+}  // namespace dp
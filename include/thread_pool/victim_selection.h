@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cpu_topology.h"
+
+namespace dp {
+    /**
+     * @brief How an idle worker picks the workers it tries to steal tasks from.
+     */
+    enum class victim_selection {
+        /// the next workers by id, i.e. `id + 1`, `id + 2`, ... (wrapping around)
+        sequential,
+        /// all other workers in order, starting at a random one for every steal attempt
+        randomized,
+        /**
+         * like randomized, but workers running on the same core, then on the same last level
+         * cache, then on the same NUMA node are tried before the remaining ones. Uses the Linux
+         * CPU topology from /sys/devices/system/cpu and falls back to randomized if it is not
+         * available.
+         */
+        topology
+    };
+
+    namespace details {
+        /**
+         * @brief Shared state for victim selection: the policy, the CPU topology and the CPU
+         * each worker was last seen on.
+         */
+        class victim_selector {
+          public:
+            victim_selector(victim_selection policy, std::size_t worker_count,
+                            cpu_topology topology = {})
+                : policy_(policy),
+                  topology_(std::move(topology)),
+                  worker_count_(worker_count),
+                  worker_cpus_(std::make_unique<std::atomic_int[]>(worker_count)) {
+                if (policy_ == victim_selection::topology && topology_.empty()) {
+                    topology_ = cpu_topology::read();
+                    if (topology_.empty()) policy_ = victim_selection::randomized;
+                }
+                for (std::size_t i = 0; i < worker_count_; ++i) worker_cpus_[i].store(-1);
+            }
+
+            [[nodiscard]] victim_selection policy() const { return policy_; }
+
+            /**
+             * @brief Record the CPU that @p worker is currently running on.
+             */
+            void update_cpu(std::size_t worker, int cpu) {
+                if (policy_ != victim_selection::topology || worker >= worker_count_) return;
+                if (worker_cpus_[worker].exchange(cpu, std::memory_order_relaxed) != cpu) {
+                    epoch_.fetch_add(1, std::memory_order_release);
+                }
+            }
+
+          private:
+            friend class victim_order;
+
+            victim_selection policy_;
+            cpu_topology topology_;
+            std::size_t worker_count_;
+            std::unique_ptr<std::atomic_int[]> worker_cpus_;
+            // incremented whenever a worker moves to another CPU
+            std::atomic_uint64_t epoch_{0};
+        };
+
+        /**
+         * @brief The order in which a single worker tries its victims. Owned by that worker.
+         */
+        class victim_order {
+          public:
+            victim_order(const victim_selector &selector, std::size_t worker, std::uint64_t seed)
+                : selector_(&selector), worker_(worker), random_state_(seed | 1) {}
+
+            /**
+             * @brief The victims for the next steal attempt, in the order they should be tried.
+             * @param worker_count The current number of workers.
+             */
+            const std::vector<std::size_t> &next(std::size_t worker_count) {
+                const auto epoch = selector_->epoch_.load(std::memory_order_acquire);
+                if (worker_count != worker_count_ || epoch != epoch_) {
+                    rebuild(worker_count);
+                    epoch_ = epoch;
+                }
+                if (selector_->policy_ == victim_selection::sequential) return victims_;
+
+                // rotate every distance level by a random offset
+                victims_.clear();
+                for (const auto &level : levels_) {
+                    if (level.empty()) continue;
+                    const auto offset = static_cast<std::size_t>(random() % level.size());
+                    victims_.insert(victims_.end(), level.begin() + offset, level.end());
+                    victims_.insert(victims_.end(), level.begin(), level.begin() + offset);
+                }
+                return victims_;
+            }
+
+          private:
+            void rebuild(std::size_t worker_count) {
+                worker_count_ = worker_count;
+                for (auto &level : levels_) level.clear();
+                victims_.clear();
+
+                const auto topology = selector_->policy_ == victim_selection::topology;
+                const auto own_cpu = cpu_of(worker_);
+                for (std::size_t j = 1; j < worker_count; ++j) {
+                    const auto victim = (worker_ + j) % worker_count;
+                    const auto level =
+                        topology ? selector_->topology_.distance(own_cpu, cpu_of(victim))
+                                 : cpu_topology::distance_levels - 1;
+                    levels_[level].push_back(victim);
+                    victims_.push_back(victim);
+                }
+            }
+
+            [[nodiscard]] int cpu_of(std::size_t worker) const {
+                if (worker >= selector_->worker_count_) return -1;
+                return selector_->worker_cpus_[worker].load(std::memory_order_relaxed);
+            }
+
+            /// xorshift64
+            std::uint64_t random() {
+                random_state_ ^= random_state_ << 13;
+                random_state_ ^= random_state_ >> 7;
+                random_state_ ^= random_state_ << 17;
+                return random_state_;
+            }
+
+            const victim_selector *selector_;
+            std::size_t worker_;
+            std::uint64_t random_state_;
+            std::size_t worker_count_{0};
+            std::uint64_t epoch_{0};
+            std::array<std::vector<std::size_t>, cpu_topology::distance_levels> levels_{};
+            std::vector<std::size_t> victims_{};
+        };
+    }  // namespace details
+}  // namespace dp
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "cache_line.h"
+#include "thread_safe_queue.h"
+
+namespace dp {
+    /**
+     * @brief Growable work stealing deque based on the Chase-Lev algorithm.
+     * @details See "Dynamic Circular Work-Stealing Deque" (Chase & Lev, 2005) and "Correct and
+     * Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013) for details.
+     *
+     * Items are pushed to (and optionally popped from) the bottom of the deque, while consumers
+     * take items from the top. Taking from the top (@ref pop_front() and @ref steal()) is lock
+     * free and can be done from any thread. Operations on the bottom of the deque
+     * (@ref push_back() and @ref pop_back()) are serialized through @p Lock so that multiple
+     * producers can safely share a deque; consumers never acquire this lock.
+     *
+     * Ring buffers replaced while growing are kept alive until the deque is destroyed so that a
+     * concurrent consumer can never read from freed memory.
+     * @tparam T The type of the items stored in the deque.
+     * @tparam Lock The lock type used to serialize producers.
+     */
+    template <typename T, typename Lock = std::mutex>
+        requires std::move_constructible<T> && is_lockable<Lock>
+    class work_stealing_deque {
+      public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /**
+         * @brief Construct a deque.
+         * @param capacity Initial capacity of the ring buffer. Will be rounded up to the next
+         * power of two.
+         * @param resource Memory resource used to allocate the items.
+         */
+        explicit work_stealing_deque(
+            size_type capacity = 1024,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : allocator_(resource) {
+            size_type actual_capacity = 1;
+            while (actual_capacity < capacity) actual_capacity <<= 1;
+
+            buffers_.emplace_back(std::make_unique<ring_buffer>(actual_capacity));
+            buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+        }
+
+        explicit work_stealing_deque(std::pmr::memory_resource *resource)
+            : work_stealing_deque(1024, resource) {}
+
+        ~work_stealing_deque() {
+            // release any items that were never consumed
+            std::ignore = clear();
+        }
+
+        /// deque is non-copyable and non-movable
+        work_stealing_deque(const work_stealing_deque &) = delete;
+        work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+
+        void push_back(T &&value) {
+            std::scoped_lock lock(mutex_);
+            push_locked(allocator_.new_object<T>(std::forward<T>(value)));
+        }
+
+        /**
+         * @brief Push multiple values to the bottom of the deque.
+         * @details The lock is acquired once and all values are published to consumers at once.
+         */
+        template <std::ranges::input_range Range>
+            requires std::convertible_to<std::ranges::range_reference_t<Range>, T>
+        void append_range(Range &&values) {
+            std::scoped_lock lock(mutex_);
+            const auto first = bottom_.load(std::memory_order_relaxed);
+            auto bottom = first;
+            auto *buffer = buffer_.load(std::memory_order_relaxed);
+
+            for (auto &&value : values) {
+                const auto top = top_.load(std::memory_order_acquire);
+                if (bottom - top > buffer->capacity() - 1) {
+                    buffer = grow(buffer, bottom, top);
+                }
+                buffer->store(bottom,
+                              allocator_.new_object<T>(std::forward<decltype(value)>(value)));
+                ++bottom;
+            }
+
+            if (bottom != first) bottom_.store(bottom, std::memory_order_release);
+        }
+
+        /**
+         * @brief Pop the most recently pushed item (LIFO).
+         */
+        [[nodiscard]] std::optional<T> pop_back() {
+            std::scoped_lock lock(mutex_);
+            const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            auto *buffer = buffer_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                // deque was empty, restore the bottom
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            auto *item = buffer->load(bottom);
+            if (top == bottom) {
+                // last item, race against consumers taking from the top
+                const auto won = top_.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                if (!won) return std::nullopt;
+            }
+
+            return take(item);
+        }
+
+        /**
+         * @brief Pop the oldest item in the deque (FIFO).
+         * @details Lock free. Only returns std::nullopt if the deque is empty.
+         */
+        [[nodiscard]] std::optional<T> pop_front() {
+            std::optional<T> item;
+            while (!try_take_top(item)) {
+            }
+            return item;
+        }
+
+        /**
+         * @brief Steal the oldest item in the deque.
+         * @details Lock free. Makes a single attempt, so std::nullopt is also returned when
+         * another consumer won the race for the top item.
+         */
+        [[nodiscard]] std::optional<T> steal() {
+            std::optional<T> item;
+            std::ignore = try_take_top(item);
+            return item;
+        }
+
+        /**
+         * @brief Steal up to half of the items in the deque at once.
+         * @details The oldest of the stolen items is returned and the others are pushed to the
+         * bottom of @p destination in order. The producer locks of both deques are held while
+         * stealing (using a deadlock avoidance algorithm), which keeps the bottom of this deque
+         * fixed so that the whole batch can be claimed from the top with a single CAS.
+         * @param destination The deque that receives the items that are not returned.
+         * @param moved If not null, set to the number of items pushed to @p destination.
+         */
+        [[nodiscard]] std::optional<T> steal_batch(work_stealing_deque &destination,
+                                                   std::size_t *moved = nullptr) {
+            if (moved != nullptr) *moved = 0;
+            if (&destination == this) return steal();
+
+            std::scoped_lock lock(mutex_, destination.mutex_);
+            const auto bottom = bottom_.load(std::memory_order_relaxed);
+            auto top = top_.load(std::memory_order_acquire);
+            std::int64_t count = 0;
+            do {
+                if (top >= bottom) return std::nullopt;
+                count = (bottom - top + 1) / 2;
+                // on failure top is reloaded, so we retry with the remaining items
+            } while (!top_.compare_exchange_weak(top, top + count, std::memory_order_seq_cst,
+                                                 std::memory_order_acquire));
+
+            // the claimed slots can't be overwritten as pushing requires our lock
+            auto *buffer = buffer_.load(std::memory_order_relaxed);
+            auto stolen = take(buffer->load(top));
+            for (auto i = top + 1; i < top + count; ++i) {
+                destination.push_locked(transfer_to(destination, buffer->load(i)));
+            }
+            if (moved != nullptr) *moved = static_cast<std::size_t>(count - 1);
+            return stolen;
+        }
+
+        [[nodiscard]] bool empty() const { return size() == 0; }
+
+        /**
+         * @brief Approximate number of items in the deque.
+         */
+        [[nodiscard]] size_type size() const {
+            const auto bottom = bottom_.load(std::memory_order_relaxed);
+            const auto top = top_.load(std::memory_order_relaxed);
+            return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+        }
+
+        size_type clear() {
+            size_type count{0};
+            while (pop_front()) ++count;
+            return count;
+        }
+
+      private:
+        class ring_buffer {
+          public:
+            explicit ring_buffer(size_type capacity)
+                : capacity_(static_cast<std::int64_t>(capacity)),
+                  mask_(capacity_ - 1),
+                  data_(std::make_unique<std::atomic<T *>[]>(capacity)) {}
+
+            [[nodiscard]] std::int64_t capacity() const { return capacity_; }
+
+            void store(std::int64_t index, T *item) {
+                data_[index & mask_].store(item, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] T *load(std::int64_t index) const {
+                return data_[index & mask_].load(std::memory_order_relaxed);
+            }
+
+          private:
+            std::int64_t capacity_;
+            std::int64_t mask_;
+            std::unique_ptr<std::atomic<T *>[]> data_;
+        };
+
+        ring_buffer *grow(ring_buffer *buffer, std::int64_t bottom, std::int64_t top) {
+            auto next = std::make_unique<ring_buffer>(static_cast<size_type>(buffer->capacity()) *
+                                                      2);
+            for (auto i = top; i < bottom; ++i) {
+                next->store(i, buffer->load(i));
+            }
+            // old buffers may still be read by consumers, so keep them around
+            buffers_.emplace_back(std::move(next));
+            buffer_.store(buffers_.back().get(), std::memory_order_release);
+            return buffers_.back().get();
+        }
+
+        /**
+         * @brief Push an item to the bottom of the deque, the lock must be held.
+         */
+        void push_locked(T *item) {
+            const auto bottom = bottom_.load(std::memory_order_relaxed);
+            const auto top = top_.load(std::memory_order_acquire);
+            auto *buffer = buffer_.load(std::memory_order_relaxed);
+
+            if (bottom - top > buffer->capacity() - 1) {
+                // the ring is full, grow it
+                buffer = grow(buffer, bottom, top);
+            }
+
+            buffer->store(bottom, item);
+            bottom_.store(bottom + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Hand an item over to another deque, only moving it if the deques use different
+         * memory resources.
+         */
+        T *transfer_to(work_stealing_deque &destination, T *item) {
+            if (allocator_ == destination.allocator_) return item;
+            auto *moved = destination.allocator_.new_object<T>(std::move(*item));
+            allocator_.delete_object(item);
+            return moved;
+        }
+
+        /**
+         * @brief Try to take the top item.
+         * @return false if the attempt lost a race with another consumer, true otherwise.
+         */
+        bool try_take_top(std::optional<T> &result) {
+            auto top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto bottom = bottom_.load(std::memory_order_acquire);
+
+            if (top >= bottom) return true;
+
+            auto *item = buffer_.load(std::memory_order_acquire)->load(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                return false;
+            }
+
+            result = take(item);
+            return true;
+        }
+
+        std::optional<T> take(T *item) {
+            std::optional<T> result{std::move(*item)};
+            allocator_.delete_object(item);
+            return result;
+        }
+
+        // written by consumers
+        alignas(details::cache_line_size) std::atomic<std::int64_t> top_{0};
+        // written by producers, the remaining members are only read by consumers
+        alignas(details::cache_line_size) std::atomic<std::int64_t> bottom_{0};
+        std::atomic<ring_buffer *> buffer_{nullptr};
+        // every buffer ever allocated, only accessed while holding the lock
+        std::vector<std::unique_ptr<ring_buffer>> buffers_{};
+        std::pmr::polymorphic_allocator<> allocator_;
+        Lock mutex_{};
+    };
+}  // namespace dp
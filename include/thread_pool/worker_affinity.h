@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "cpu_topology.h"
+
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace dp {
+    /**
+     * @brief How workers are distributed over the CPUs they may run on.
+     */
+    enum class worker_placement {
+        /// workers are not pinned and the OS scheduler decides where they run
+        none,
+        /// fill the CPUs of one NUMA node before using the next one, keeps workers close together
+        compact,
+        /// alternate between NUMA nodes, maximizes the available memory bandwidth
+        spread
+    };
+
+    /**
+     * @brief Where the workers of a dp::thread_pool run.
+     * @details Workers are pinned to a single CPU each (or to a set of CPUs with @ref cpu_sets)
+     * when they start, before the initialization function of the pool is invoked. Memory that a
+     * worker touches first, like the per-thread caches of dp::recycling_memory_resource, is
+     * therefore allocated on its own NUMA node. Only supported on Linux, elsewhere workers are
+     * never pinned.
+     */
+    struct worker_affinity {
+        worker_placement placement = worker_placement::none;
+        /// CPUs to place workers on, defaults to all CPUs the constructing thread may run on
+        std::vector<int> cpus{};
+        /// only use the first hardware thread of every core
+        bool skip_smt_siblings = false;
+        /**
+         * explicit CPU sets, worker i is pinned to `cpu_sets[i % cpu_sets.size()]`. Takes
+         * precedence over @ref placement.
+         */
+        std::vector<std::vector<int>> cpu_sets{};
+    };
+
+    namespace details {
+        /**
+         * @brief The CPUs the calling thread may run on, empty if unknown.
+         */
+        inline std::vector<int> current_thread_cpus() {
+            std::vector<int> cpus;
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+                }
+            }
+#endif
+            return cpus;
+        }
+
+        /**
+         * @brief Pin the calling thread to @p cpus.
+         * @return true on success.
+         */
+        inline bool set_current_thread_cpus([[maybe_unused]] const std::vector<int> &cpus) {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (const auto cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+            }
+            return CPU_COUNT(&set) > 0 &&
+                   pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Compute the CPU set of every worker.
+         * @param allowed The CPUs used if @p affinity doesn't list any.
+         * @return One CPU set per worker, or an empty vector if the workers should not be pinned.
+         */
+        inline std::vector<std::vector<int>> plan_worker_cpus(const worker_affinity &affinity,
+                                                              std::size_t worker_count,
+                                                              const cpu_topology &topology,
+                                                              const std::vector<int> &allowed) {
+            std::vector<std::vector<int>> plan;
+            if (worker_count == 0) return plan;
+
+            if (!affinity.cpu_sets.empty()) {
+                for (std::size_t i = 0; i < worker_count; ++i) {
+                    plan.push_back(affinity.cpu_sets[i % affinity.cpu_sets.size()]);
+                }
+                return plan;
+            }
+            if (affinity.placement == worker_placement::none) return plan;
+
+            auto candidates = affinity.cpus.empty() ? allowed : affinity.cpus;
+            std::ranges::sort(candidates);
+            const auto [first, last] = std::ranges::unique(candidates);
+            candidates.erase(first, last);
+
+            // group the CPUs by NUMA node, keeping only one CPU per core if requested
+            std::map<int, std::vector<int>> nodes;
+            std::vector<int> used_cores;
+            for (const auto cpu : candidates) {
+                if (cpu < 0) continue;
+                const auto core = topology.core(cpu);
+                if (affinity.skip_smt_siblings && core >= 0) {
+                    if (std::ranges::find(used_cores, core) != used_cores.end()) continue;
+                    used_cores.push_back(core);
+                }
+                nodes[topology.node(cpu)].push_back(cpu);
+            }
+
+            std::vector<int> order;
+            if (affinity.placement == worker_placement::compact) {
+                for (const auto &[node, cpus] : nodes) {
+                    order.insert(order.end(), cpus.begin(), cpus.end());
+                }
+            } else {
+                // the first CPU of every node, then the second one and so on
+                for (std::size_t index = 0;; ++index) {
+                    const auto size = order.size();
+                    for (const auto &[node, cpus] : nodes) {
+                        if (index < cpus.size()) order.push_back(cpus[index]);
+                    }
+                    if (order.size() == size) break;
+                }
+            }
+            if (order.empty()) return plan;
+
+            for (std::size_t i = 0; i < worker_count; ++i) {
+                plan.push_back({order[i % order.size()]});
+            }
+            return plan;
+        }
+
+        /**
+         * @brief Compute the CPU set of every worker on this machine.
+         */
+        inline std::vector<std::vector<int>> plan_worker_cpus(const worker_affinity &affinity,
+                                                              std::size_t worker_count) {
+            if (!affinity.cpu_sets.empty()) return plan_worker_cpus(affinity, worker_count, {}, {});
+            if (affinity.placement == worker_placement::none) return {};
+            return plan_worker_cpus(affinity, worker_count, cpu_topology::read(),
+                                    current_thread_cpus());
+        }
+    }  // namespace details
+}  // namespace dp
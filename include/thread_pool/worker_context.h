@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#include "worker_signal.h"
+
+namespace dp::details {
+    /**
+     * @brief Identifies the pool and worker that the current thread belongs to (if any).
+     */
+    struct worker_context {
+        void *pool{nullptr};
+        std::size_t id{0};
+        /// runs one pending task of the pool on this worker, false if there was nothing to run
+        bool (*run_pending_task)(void *pool, std::size_t id){nullptr};
+        /// whether the pool has tasks that have not been started yet
+        bool (*has_pending_tasks)(const void *pool){nullptr};
+        /// how long to spin and yield before parking, see dp::thread_pool_options
+        const idle_strategy *idle{nullptr};
+    };
+
+    inline thread_local worker_context current_worker{};
+
+    /**
+     * @brief Workers that are parked in help_while_waiting(), of any pool.
+     */
+    struct waiting_workers {
+        std::atomic_uint32_t parked{0};
+        // changed to wake up the parked workers
+        std::atomic_uint32_t epoch{0};
+    };
+
+    inline waiting_workers parked_workers{};
+
+    /**
+     * @brief Wake up the workers parked in help_while_waiting() so that they check what they
+     * wait for again.
+     * @details Must be called after every change that can end such a wait, i.e. completing what
+     * is waited for or making a task available, and the change must be a sequentially consistent
+     * operation (or be followed by a sequentially consistent fence). Either this then sees the
+     * parked worker, or the worker sees the change before it parks. Only a load unless a worker
+     * is parked.
+     */
+    inline void notify_waiting_workers() {
+        if (parked_workers.parked.load(std::memory_order_seq_cst) == 0) return;
+        parked_workers.epoch.fetch_add(1, std::memory_order_seq_cst);
+        parked_workers.epoch.notify_all();
+    }
+
+    /**
+     * @brief Wait until @p done returns true by running pending tasks of the pool that the
+     * calling thread works for.
+     * @details Blocking a worker thread wastes a core and, with nested parallelism, can deadlock
+     * the pool when every worker waits for tasks that are still queued. Tasks run while waiting
+     * execute on the stack of the waiting one, so they must not depend on locks held by it.
+     * If there is nothing to run, the worker follows the dp::idle_strategy of its pool and then
+     * parks until notify_waiting_workers() is called.
+     * @return false if the calling thread is not a pool worker, in which case the caller has to
+     * block instead.
+     */
+    template <typename Predicate>
+    bool help_while_waiting(Predicate &&done) {
+        const auto worker = current_worker;
+        if (worker.run_pending_task == nullptr) return false;
+        const auto spin_count = worker.idle->spin_count;
+        const auto backoff_count = spin_count + worker.idle->yield_count;
+        std::uint32_t failed = 0;
+        while (!done()) {
+            if (worker.run_pending_task(worker.pool, worker.id)) {
+                failed = 0;
+                continue;
+            }
+            // other workers are still busy with the tasks we wait for
+            if (failed < backoff_count) {
+                if (failed++ < spin_count) {
+                    cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+
+            parked_workers.parked.fetch_add(1, std::memory_order_seq_cst);
+            // pairs with notify_waiting_workers(), see there
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto epoch = parked_workers.epoch.load(std::memory_order_seq_cst);
+            const auto wait = !done() && !worker.has_pending_tasks(worker.pool);
+            if (wait) parked_workers.epoch.wait(epoch, std::memory_order_seq_cst);
+            parked_workers.parked.fetch_sub(1, std::memory_order_relaxed);
+            // a task that was just submitted may not be in a queue yet
+            if (!wait) std::this_thread::yield();
+            failed = 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Enqueue a task that continues work which was already submitted, like a chunk of
+     * dp::parallel_for or a node of a dp::task_graph.
+     * @details Uses dp::thread_pool::enqueue_continuation() if @p pool has it, so that the task
+     * is never delayed or rejected by the overflow policy of a bounded pool, and enqueue_detach()
+     * otherwise.
+     */
+    template <typename Pool, typename Function>
+    void enqueue_continuation(Pool &pool, Function &&func) {
+        if constexpr (requires { pool.enqueue_continuation(std::forward<Function>(func)); }) {
+            pool.enqueue_continuation(std::forward<Function>(func));
+        } else {
+            pool.enqueue_detach(std::forward<Function>(func));
+        }
+    }
+}  // namespace dp::details
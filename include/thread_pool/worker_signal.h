@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#endif
+
+namespace dp {
+    /**
+     * @brief How a worker waits for new tasks once it runs out of work.
+     * @details The worker first checks for a wake-up @ref spin_count times, pausing the CPU in
+     * between, then calls std::this_thread::yield() up to @ref yield_count times and finally
+     * parks until it is woken up. Spinning and yielding trade CPU time for a lower wake-up latency
+     * with bursty workloads, since waking up a parked worker takes a system call. The default
+     * parks right away.
+     */
+    struct idle_strategy {
+        std::uint32_t spin_count = 0;
+        std::uint32_t yield_count = 0;
+    };
+
+    namespace details {
+        /**
+         * @brief Hint to the CPU that we are in a spin-wait loop.
+         */
+        inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+        /**
+         * @brief Wake-up signal of a single worker.
+         * @details Behaves like a binary semaphore, except that waiting follows an
+         * dp::idle_strategy and that notify() only makes a system call if the worker is parked.
+         * Multiple notifications before the worker wakes up are coalesced into one.
+         */
+        class worker_signal {
+          public:
+            /**
+             * @brief Wake up the worker, or make its next wait() return immediately.
+             */
+            void notify() {
+                if (state_.exchange(notified, std::memory_order_acq_rel) == parked) {
+                    state_.notify_one();
+                }
+            }
+
+            /**
+             * @brief Wait for a notification. Must only be called by the owning worker.
+             */
+            void wait(const idle_strategy &strategy) {
+                for (std::uint32_t i = 0; i < strategy.spin_count; ++i) {
+                    if (try_consume()) return;
+                    cpu_relax();
+                }
+                for (std::uint32_t i = 0; i < strategy.yield_count; ++i) {
+                    if (try_consume()) return;
+                    std::this_thread::yield();
+                }
+
+                auto expected = running;
+                if (state_.compare_exchange_strong(expected, parked, std::memory_order_acq_rel)) {
+                    // must be a loop to ignore spurious wake-ups
+                    do {
+                        state_.wait(parked, std::memory_order_acquire);
+                    } while (state_.load(std::memory_order_acquire) == parked);
+                }
+                // consume the notification
+                state_.exchange(running, std::memory_order_acq_rel);
+            }
+
+            /**
+             * @brief Whether the worker is parked, i.e. notify() has to make a system call.
+             */
+            [[nodiscard]] bool is_parked() const {
+                return state_.load(std::memory_order_relaxed) == parked;
+            }
+
+          private:
+            bool try_consume() {
+                if (state_.load(std::memory_order_relaxed) != notified) return false;
+                state_.exchange(running, std::memory_order_acq_rel);
+                return true;
+            }
+
+            static constexpr std::uint32_t running = 0;
+            static constexpr std::uint32_t notified = 1;
+            static constexpr std::uint32_t parked = 2;
+
+            std::atomic<std::uint32_t> state_{running};
+        };
+    }  // namespace details
+}  // namespace dp
@@ -0,0 +1,57 @@
+#include <doctest/doctest.h>
+#include <thread_pool/cpu_topology.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("Ensure CPU lists are parsed") {
+    using dp::details::parse_cpu_list;
+    const std::vector expected{0, 1, 2, 3, 8, 10, 11};
+    CHECK_EQ(parse_cpu_list("0-3,8,10-11\n"), expected);
+    CHECK_EQ(parse_cpu_list("5"), std::vector{5});
+    CHECK(parse_cpu_list("").empty());
+    CHECK(parse_cpu_list("a-b").empty());
+}
+
+TEST_CASE("Ensure the CPU topology is read from sysfs") {
+    // 2 NUMA nodes with one last level cache each, 2 cores per cache and 2 threads per core
+    const auto root = std::filesystem::temp_directory_path() / "dp_thread_pool_topology";
+    std::filesystem::remove_all(root);
+    auto write = [](const std::filesystem::path& path, const std::string& content) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << content << '\n';
+    };
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        const auto path = root / ("cpu" + std::to_string(cpu));
+        const auto core = cpu / 2 * 2;
+        const auto cache = cpu / 4 * 4;
+        write(path / "topology" / "thread_siblings_list",
+              std::to_string(core) + "-" + std::to_string(core + 1));
+        write(path / "cache" / "index0" / "level", "1");
+        write(path / "cache" / "index0" / "type", "Data");
+        write(path / "cache" / "index0" / "shared_cpu_list", std::to_string(cpu));
+        write(path / "cache" / "index3" / "level", "3");
+        write(path / "cache" / "index3" / "type", "Unified");
+        write(path / "cache" / "index3" / "shared_cpu_list",
+              std::to_string(cache) + "-" + std::to_string(cache + 3));
+        std::filesystem::create_directories(path / ("node" + std::to_string(cpu / 4)));
+    }
+    // not a CPU
+    std::filesystem::create_directories(root / "cpufreq");
+
+    const auto topology = dp::details::cpu_topology::read(root);
+    std::filesystem::remove_all(root);
+
+    REQUIRE_FALSE(topology.empty());
+    CHECK_EQ(topology.distance(0, 1), 0);
+    CHECK_EQ(topology.distance(0, 2), 1);
+    CHECK_EQ(topology.distance(0, 5), 3);
+    CHECK_EQ(topology.distance(6, 7), 0);
+    CHECK_EQ(topology.distance(0, -1), 3);
+    CHECK_EQ(topology.distance(0, 100), 3);
+    CHECK_EQ(topology.core(3), 2);
+    CHECK_EQ(topology.node(5), 1);
+    CHECK_EQ(topology.node(100), -1);
+}
@@ -0,0 +1,215 @@
+#include <doctest/doctest.h>
+#include <thread_pool/future.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+TEST_CASE("Ensure dp::future returns the value set by the promise") {
+    dp::promise<int> promise;
+    auto future = promise.get_future();
+    CHECK(future.valid());
+    CHECK_FALSE(future.is_ready());
+
+    promise.set_value(42);
+    CHECK(future.is_ready());
+    CHECK_EQ(future.get(), 42);
+    CHECK_FALSE(future.valid());
+}
+
+TEST_CASE("Ensure dp::future blocks until the value is set from another thread") {
+    dp::promise<std::string> promise;
+    auto future = promise.get_future();
+
+    std::jthread setter([promise = std::move(promise)]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        promise.set_value("hello");
+    });
+
+    CHECK_EQ(future.get(), "hello");
+}
+
+TEST_CASE("Ensure dp::future supports void, references and move-only types") {
+    dp::promise<void> void_promise;
+    auto void_future = void_promise.get_future();
+    void_promise.set_value();
+    CHECK_NOTHROW(void_future.get());
+
+    int value = 1;
+    dp::promise<int &> reference_promise;
+    auto reference_future = reference_promise.get_future();
+    reference_promise.set_value(value);
+    reference_future.get() = 2;
+    CHECK_EQ(value, 2);
+
+    dp::promise<std::unique_ptr<int>> unique_promise;
+    auto unique_future = unique_promise.get_future();
+    unique_promise.set_value(std::make_unique<int>(3));
+    CHECK_EQ(*unique_future.get(), 3);
+}
+
+TEST_CASE("Ensure dp::future rethrows exceptions") {
+    dp::promise<int> promise;
+    auto future = promise.get_future();
+    promise.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+    CHECK_THROWS_AS(future.get(), std::runtime_error);
+}
+
+TEST_CASE("Ensure dp::promise reports errors") {
+    SUBCASE("Broken promise") {
+        dp::future<int> future;
+        {
+            dp::promise<int> promise;
+            auto copy = promise;
+            future = promise.get_future();
+        }
+        CHECK_THROWS_AS(future.get(), std::future_error);
+    }
+
+    SUBCASE("Already satisfied") {
+        dp::promise<int> promise;
+        promise.set_value(1);
+        CHECK_THROWS_AS(promise.set_value(2), std::future_error);
+    }
+
+    SUBCASE("Future already retrieved") {
+        dp::promise<int> promise;
+        auto future = promise.get_future();
+        CHECK_THROWS_AS(std::ignore = promise.get_future(), std::future_error);
+    }
+
+    SUBCASE("No state") {
+        dp::future<int> future;
+        CHECK_FALSE(future.valid());
+        CHECK_THROWS_AS(future.get(), std::future_error);
+    }
+}
+
+TEST_CASE("Ensure copies of dp::promise share their state") {
+    dp::promise<int> promise;
+    auto future = promise.get_future();
+    {
+        auto copy = promise;
+        copy.set_value(7);
+    }
+    CHECK_EQ(future.get(), 7);
+}
+
+namespace {
+    // runs continuations right away on the thread that completes the antecedent
+    struct inline_executor {
+        template <typename Function>
+        void enqueue_detach(Function &&function) {
+            ++count;
+            std::invoke(function);
+        }
+
+        int count = 0;
+    };
+}  // namespace
+
+TEST_CASE("Ensure dp::future::then runs the continuation once the result is set") {
+    inline_executor executor;
+    dp::promise<int> promise;
+    auto doubled = promise.get_future().then(executor, [](int value) { return value * 2; });
+    auto text = std::move(doubled).then(executor, [](int value) { return std::to_string(value); });
+    CHECK_EQ(executor.count, 0);
+    CHECK_FALSE(text.is_ready());
+
+    promise.set_value(21);
+    CHECK_EQ(executor.count, 2);
+    CHECK_EQ(text.get(), "42");
+
+    // attached to a ready future, the continuation is scheduled right away
+    dp::promise<void> ready;
+    ready.set_value();
+    auto after = ready.get_future().then(executor, [] { return 1; });
+    CHECK_EQ(after.get(), 1);
+}
+
+TEST_CASE("Ensure dp::future::then passes on exceptions") {
+    inline_executor executor;
+    dp::promise<int> promise;
+    auto skipped = promise.get_future().then(executor, [](int value) { return value; });
+    promise.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+    CHECK_THROWS_AS(skipped.get(), std::runtime_error);
+
+    // a continuation taking the future can handle the exception itself
+    dp::promise<int> other;
+    auto handled = other.get_future().then(executor, [](dp::future<int> antecedent) {
+        try {
+            return antecedent.get();
+        } catch (const std::runtime_error &) {
+            return -1;
+        }
+    });
+    other.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+    CHECK_EQ(handled.get(), -1);
+
+    // a broken promise reaches the continuation as well
+    dp::future<int> broken;
+    {
+        dp::promise<int> dropped;
+        broken = dropped.get_future().then(executor, [](int value) { return value; });
+    }
+    CHECK_THROWS_AS(broken.get(), std::future_error);
+}
+
+TEST_CASE("Ensure dp::when_all completes once all futures are ready") {
+    std::vector<dp::promise<int>> promises(3);
+    std::vector<dp::future<int>> futures;
+    for (auto &promise : promises) futures.push_back(promise.get_future());
+    auto all = dp::when_all(std::move(futures));
+
+    promises[2].set_value(2);
+    promises[0].set_value(0);
+    CHECK_FALSE(all.is_ready());
+    promises[1].set_value(1);
+    REQUIRE(all.is_ready());
+
+    auto ready = all.get();
+    REQUIRE_EQ(ready.size(), 3);
+    for (auto i = 0; i < 3; ++i) CHECK_EQ(ready[i].get(), i);
+
+    CHECK(dp::when_all(std::vector<dp::future<int>>{}).is_ready());
+}
+
+TEST_CASE("Ensure dp::when_all supports futures of different types") {
+    dp::promise<int> number;
+    dp::promise<std::string> text;
+    dp::promise<void> done;
+    auto all = dp::when_all(number.get_future(), text.get_future(), done.get_future());
+
+    text.set_value("text");
+    done.set_value();
+    CHECK_FALSE(all.is_ready());
+    number.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+    auto [first, second, third] = all.get();
+    CHECK_THROWS_AS(first.get(), std::runtime_error);
+    CHECK_EQ(second.get(), "text");
+    CHECK_NOTHROW(third.get());
+}
+
+TEST_CASE("Ensure dp::when_any completes with the first ready future") {
+    std::vector<dp::promise<int>> promises(3);
+    std::vector<dp::future<int>> futures;
+    for (auto &promise : promises) futures.push_back(promise.get_future());
+    auto any = dp::when_any(std::move(futures));
+    CHECK_FALSE(any.is_ready());
+
+    promises[1].set_value(1);
+    REQUIRE(any.is_ready());
+    auto result = any.get();
+    CHECK_EQ(result.index, 1);
+    REQUIRE_EQ(result.futures.size(), 3);
+    CHECK_EQ(result.futures[1].get(), 1);
+
+    // the remaining futures can still be used
+    CHECK_FALSE(result.futures[0].is_ready());
+    promises[0].set_value(0);
+    CHECK_EQ(result.futures[0].get(), 0);
+}
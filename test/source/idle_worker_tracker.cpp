@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+#include <thread_pool/idle_worker_tracker.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ensure idle workers are claimed only once") {
+    constexpr std::size_t worker_count = 130;
+    dp::details::idle_worker_tracker tracker(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) tracker.add_worker(i);
+    CHECK_EQ(tracker.size(), worker_count);
+
+    std::vector<int> claimed(worker_count, 0);
+    while (const auto id = tracker.try_claim_any()) {
+        REQUIRE_LT(*id, worker_count);
+        ++claimed[*id];
+    }
+    CHECK(std::ranges::all_of(claimed, [](int count) { return count == 1; }));
+
+    // all workers are busy now
+    CHECK_FALSE(tracker.try_claim(5));
+    tracker.mark_idle(5);
+    CHECK(tracker.try_claim(5));
+    CHECK_FALSE(tracker.try_claim_any().has_value());
+}
+
+TEST_CASE("Ensure round-robin order covers all workers") {
+    dp::details::idle_worker_tracker tracker(3);
+    for (std::size_t i = 0; i < 3; ++i) tracker.add_worker(i);
+
+    CHECK_EQ(tracker.next(), 0);
+    CHECK_EQ(tracker.next(), 1);
+    CHECK_EQ(tracker.next(), 2);
+    CHECK_EQ(tracker.next(), 0);
+}
+
+TEST_CASE("Ensure removed workers are no longer handed out") {
+    dp::details::idle_worker_tracker tracker(4);
+    for (std::size_t i = 0; i < 4; ++i) tracker.add_worker(i);
+    tracker.remove_worker(3);
+    tracker.remove_worker(2);
+    CHECK_EQ(tracker.size(), 2);
+
+    for (auto i = 0; i < 4; ++i) CHECK_LT(tracker.next(), 2);
+    CHECK_EQ(tracker.try_claim_any(), 0);
+    CHECK_EQ(tracker.try_claim_any(), 1);
+    CHECK_FALSE(tracker.try_claim_any().has_value());
+
+    // a removed worker can be added again
+    tracker.add_worker(2);
+    CHECK_EQ(tracker.try_claim_any(), 2);
+}
+
+TEST_CASE("Ensure idle workers can be claimed with thread contention") {
+    constexpr std::size_t worker_count = 64;
+    constexpr auto rounds = 1000;
+    dp::details::idle_worker_tracker tracker(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) tracker.add_worker(i);
+
+    std::vector<std::atomic_int> owners(worker_count);
+    std::atomic_bool double_claim{false};
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                for (int r = 0; r < rounds; ++r) {
+                    if (const auto id = tracker.try_claim_any()) {
+                        if (owners[*id].fetch_add(1) != 0) double_claim = true;
+                        owners[*id].fetch_sub(1);
+                        tracker.mark_idle(*id);
+                    }
+                }
+            });
+        }
+    }
+
+    CHECK_FALSE(double_claim.load());
+}
@@ -0,0 +1,71 @@
+#include <doctest/doctest.h>
+#include <thread_pool/inplace_function.h>
+#include <thread_pool/thread_pool.h>
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+TEST_CASE("Ensure inplace_function invokes the stored callable") {
+    dp::inplace_function<int(int, int)> add = [](int a, int b) { return a + b; };
+    CHECK(static_cast<bool>(add));
+    CHECK_EQ(add(2, 3), 5);
+
+    std::string prefix = "hello ";
+    dp::inplace_function<std::string(const std::string&)> greet =
+        [prefix](const std::string& name) { return prefix + name; };
+    CHECK_EQ(greet("world"), "hello world");
+
+    dp::inplace_function<void()> empty;
+    CHECK_FALSE(static_cast<bool>(empty));
+    CHECK_THROWS_AS(empty(), std::bad_function_call);
+}
+
+TEST_CASE("Ensure inplace_function supports move-only callables") {
+    auto value = std::make_unique<int>(42);
+    dp::inplace_function<int()> first = [value = std::move(value)] { return *value; };
+
+    dp::inplace_function<int()> second = std::move(first);
+    CHECK_FALSE(static_cast<bool>(first));
+    CHECK_EQ(second(), 42);
+
+    dp::inplace_function<int()> third;
+    third = std::move(second);
+    CHECK_FALSE(static_cast<bool>(second));
+    CHECK_EQ(third(), 42);
+}
+
+TEST_CASE("Ensure inplace_function destroys the stored callable") {
+    auto tracker = std::make_shared<int>(0);
+    {
+        dp::inplace_function<void()> function = [tracker] {};
+        CHECK_EQ(tracker.use_count(), 2);
+        dp::inplace_function<void()> moved = std::move(function);
+        CHECK_EQ(tracker.use_count(), 2);
+    }
+    CHECK_EQ(tracker.use_count(), 1);
+}
+
+TEST_CASE("Ensure inplace_function reports whether a callable fits") {
+    using function_type = dp::inplace_function<void(), 16>;
+    auto small = [a = std::array<char, 16>{}] { std::ignore = a; };
+    auto large = [a = std::array<char, 17>{}] { std::ignore = a; };
+    CHECK(function_type::fits<decltype(small)>);
+    CHECK_FALSE(function_type::fits<decltype(large)>);
+}
+
+TEST_CASE("Ensure inplace_function can be used as the thread_pool function type") {
+    std::atomic_int counter = 0;
+    {
+        dp::thread_pool<dp::inplace_function<void()>> pool(4);
+        auto future = pool.enqueue([](int a, int b) { return a * b; }, 3, 4);
+        CHECK_EQ(future.get(), 12);
+
+        for (int i = 0; i < 100; ++i) {
+            pool.enqueue_detach([&counter](int amount) { counter.fetch_add(amount); }, 2);
+        }
+    }
+    CHECK_EQ(counter.load(), 200);
+}
@@ -0,0 +1,170 @@
+#include <doctest/doctest.h>
+#include <thread_pool/parallel.h>
+#include <thread_pool/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("Ensure parallel_for visits every index once") {
+    unsigned int thread_count = 0;
+    std::size_t grain = 0;
+    SUBCASE("with no thread") { thread_count = 0; }
+    SUBCASE("with single thread") { thread_count = 1; }
+    SUBCASE("with multiple threads") { thread_count = 4; }
+    SUBCASE("with multiple threads and a grain size") {
+        thread_count = 4;
+        grain = 7;
+    }
+
+    dp::thread_pool pool(thread_count);
+    constexpr auto count = 10'000;
+    std::vector<std::atomic_int> visits(count);
+    dp::parallel_for(pool, 0, count, [&visits](int i) { visits[i].fetch_add(1); }, grain);
+
+    CHECK(std::ranges::all_of(visits, [](const std::atomic_int& value) { return value == 1; }));
+
+    // empty ranges are a no-op
+    dp::parallel_for(pool, 10, 10, [&visits](int i) { visits[i].fetch_add(1); });
+    dp::parallel_for(pool, 10, 5, [&visits](int i) { visits[i].fetch_add(1); });
+    CHECK_EQ(visits[5].load(), 1);
+}
+
+TEST_CASE("Ensure parallel_for_each visits every element") {
+    dp::thread_pool pool(4);
+    std::vector<int> values(5000);
+    std::iota(values.begin(), values.end(), 0);
+
+    dp::parallel_for_each(pool, values, [](int& value) { value *= 2; });
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQ(values[i], 2 * static_cast<int>(i));
+    }
+
+    dp::parallel_for_each(pool, values.begin(), values.begin() + 10, [](int& value) { value = -1; },
+                          3);
+    CHECK_EQ(std::ranges::count(values, -1), 10);
+}
+
+TEST_CASE("Ensure parallel_for rethrows exceptions from the body") {
+    dp::thread_pool pool(4);
+    std::atomic_int visited = 0;
+    CHECK_THROWS_AS(dp::parallel_for(
+                        pool, 0, 1000,
+                        [&visited](int i) {
+                            visited.fetch_add(1);
+                            if (i == 500) throw std::runtime_error("error");
+                        },
+                        10),
+                    std::runtime_error);
+    // the pool is still usable afterwards
+    CHECK_EQ(pool.enqueue([] { return 3; }).get(), 3);
+}
+
+TEST_CASE("Ensure parallel_for doesn't wait for chunks cleared from the pool") {
+    dp::thread_pool pool(1);
+    std::atomic_bool started{false};
+    std::atomic_bool release{false};
+    pool.enqueue_detach([&started, &release] {
+        started.store(true);
+        while (!release.load()) std::this_thread::yield();
+    });
+    while (!started.load()) std::this_thread::yield();
+
+    // the caller enqueues the upper chunks before it processes the first chunk itself
+    std::atomic_bool split_done{false};
+    auto result = std::async(std::launch::async, [&] {
+        dp::parallel_for(
+            pool, 0, 100,
+            [&](int) {
+                split_done.store(true);
+                while (!release.load()) std::this_thread::yield();
+            },
+            10);
+    });
+    while (!split_done.load()) std::this_thread::yield();
+    CHECK_GT(pool.clear_tasks(), 0);
+    release.store(true);
+
+    try {
+        result.get();
+        FAIL("parallel_for should report the dropped chunks");
+    } catch (const std::future_error& error) {
+        CHECK_EQ(error.code(), std::future_errc::broken_promise);
+    }
+}
+
+TEST_CASE("Ensure parallel_for ignores the overflow policy of a bounded pool") {
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 2, .queue_capacity = 2, .overflow = dp::overflow_policy::fail});
+    std::vector<std::atomic_int> visits(1000);
+    dp::parallel_for(pool, 0, 1000, [&visits](int i) { visits[i].fetch_add(1); }, 10);
+    CHECK(std::ranges::all_of(visits, [](const auto& count) { return count.load() == 1; }));
+
+    // and from a worker
+    std::atomic_int counter{0};
+    pool.enqueue([&pool, &counter] {
+            dp::parallel_for(pool, 0, 1000, [&counter](int) { counter.fetch_add(1); }, 10);
+        })
+        .get();
+    CHECK_EQ(counter.load(), 1000);
+}
+
+TEST_CASE("Ensure parallel_reduce matches std::accumulate") {
+    unsigned int thread_count = 0;
+    std::size_t grain = 0;
+    SUBCASE("with no thread") { thread_count = 0; }
+    SUBCASE("with single thread") { thread_count = 1; }
+    SUBCASE("with multiple threads") { thread_count = 4; }
+    SUBCASE("with multiple threads and a grain size") {
+        thread_count = 4;
+        grain = 3;
+    }
+
+    dp::thread_pool pool(thread_count);
+    std::vector<std::int64_t> values(10'001);
+    std::iota(values.begin(), values.end(), 0);
+
+    const auto expected = std::accumulate(values.begin(), values.end(), std::int64_t{5});
+    CHECK_EQ(dp::parallel_reduce(pool, values, std::int64_t{5}, std::plus<>{}, grain), expected);
+    CHECK_EQ(dp::parallel_reduce(pool, values.begin(), values.end(), std::int64_t{5}), expected);
+
+    // empty ranges return the initial value
+    CHECK_EQ(dp::parallel_reduce(pool, values.begin(), values.begin(), std::int64_t{5}), 5);
+}
+
+TEST_CASE("Ensure parallel_reduce preserves order for non-commutative operations") {
+    dp::thread_pool pool(4);
+    std::vector<std::string> words;
+    std::string expected = ">";
+    for (int i = 0; i < 500; ++i) {
+        words.push_back(std::to_string(i) + ",");
+        expected += words.back();
+    }
+
+    for (std::size_t grain : {0, 1, 7, 1000}) {
+        CHECK_EQ(dp::parallel_reduce(pool, words, std::string(">"), std::plus<>{}, grain),
+                 expected);
+    }
+}
+
+TEST_CASE("Ensure parallel_transform_reduce transforms every element") {
+    dp::thread_pool pool(4);
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 1);
+
+    const auto count_even = dp::parallel_transform_reduce(
+        pool, values, std::size_t{0}, std::plus<>{},
+        [](int value) -> std::size_t { return value % 2 == 0 ? 1 : 0; });
+    CHECK_EQ(count_even, 500);
+
+    const auto max_square = dp::parallel_transform_reduce(
+        pool, values.begin(), values.end(), 0, [](int a, int b) { return std::max(a, b); },
+        [](int value) { return value * value; }, 16);
+    CHECK_EQ(max_square, 1000 * 1000);
+}
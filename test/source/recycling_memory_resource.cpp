@@ -0,0 +1,132 @@
+#include <doctest/doctest.h>
+#include <thread_pool/recycling_memory_resource.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Forwards to the default resource and counts the allocations.
+     */
+    class counting_resource : public std::pmr::memory_resource {
+      public:
+        std::atomic_size_t allocations{0};
+
+      protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            allocations.fetch_add(1);
+            return std::pmr::get_default_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+        }
+        [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+}  // namespace
+
+TEST_CASE("Ensure recycling_memory_resource reuses blocks on the same thread") {
+    dp::recycling_memory_resource resource;
+    auto* first = resource.allocate(24);
+    resource.deallocate(first, 24);
+    // same size class
+    auto* second = resource.allocate(32);
+    CHECK_EQ(first, second);
+    // different size class
+    auto* third = resource.allocate(100);
+    CHECK_NE(second, third);
+    resource.deallocate(second, 32);
+    resource.deallocate(third, 100);
+}
+
+TEST_CASE("Ensure recycling_memory_resource returns aligned memory") {
+    dp::recycling_memory_resource resource;
+    for (std::size_t bytes : {1, 7, 16, 33, 500, 1024, 4096}) {
+        auto* pointer = resource.allocate(bytes);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(pointer) % alignof(std::max_align_t), 0);
+        resource.deallocate(pointer, bytes);
+    }
+
+    constexpr std::size_t over_aligned = 2 * alignof(std::max_align_t);
+    auto* pointer = resource.allocate(64, over_aligned);
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(pointer) % over_aligned, 0);
+    resource.deallocate(pointer, 64, over_aligned);
+}
+
+TEST_CASE("Ensure recycling_memory_resource forwards large blocks upstream") {
+    counting_resource upstream;
+    dp::recycling_memory_resource resource(&upstream);
+    CHECK_EQ(resource.upstream_resource(), &upstream);
+
+    auto* pointer = resource.allocate(dp::recycling_memory_resource::max_block_size + 1);
+    CHECK_EQ(upstream.allocations.load(), 1);
+    resource.deallocate(pointer, dp::recycling_memory_resource::max_block_size + 1);
+}
+
+TEST_CASE("Ensure recycling_memory_resource recycles blocks freed by other threads") {
+    counting_resource upstream;
+    dp::recycling_memory_resource resource(&upstream);
+    constexpr auto block_count = 1000;
+
+    auto allocate_and_free_remotely = [&] {
+        std::vector<void*> blocks;
+        for (int i = 0; i < block_count; ++i) blocks.push_back(resource.allocate(64));
+        std::jthread([&] {
+            for (auto* block : blocks) resource.deallocate(block, 64);
+        }).join();
+    };
+
+    allocate_and_free_remotely();
+    const auto warm_allocations = upstream.allocations.load();
+    CHECK_GT(warm_allocations, 0);
+
+    // every block is reclaimed from the remote free list, so the upstream is not used anymore
+    allocate_and_free_remotely();
+    allocate_and_free_remotely();
+    CHECK_EQ(upstream.allocations.load(), warm_allocations);
+}
+
+namespace {
+    /**
+     * @brief Sets a flag when the thread that created it exits, after the thread local state of
+     * the resource was destroyed.
+     */
+    struct exit_signal {
+        std::atomic_bool* exited{nullptr};
+        ~exit_signal() {
+            if (exited != nullptr) exited->store(true);
+        }
+    };
+
+    thread_local exit_signal current_exit_signal{};
+}  // namespace
+
+TEST_CASE("Ensure recycling_memory_resource reuses the caches of exited threads") {
+    counting_resource upstream;
+    dp::recycling_memory_resource resource(&upstream);
+    constexpr auto thread_count = 20;
+
+    // threads are only joined at the end, so every thread has a different id
+    std::vector<std::atomic_bool> exited(thread_count);
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        if (i > 0) {
+            while (!exited[i - 1].load()) std::this_thread::yield();
+        }
+        threads.emplace_back([&, i] {
+            // created before the state of the resource, so it is destroyed after it
+            current_exit_signal.exited = &exited[i];
+            auto* block = resource.allocate(64);
+            resource.deallocate(block, 64);
+        });
+    }
+    threads.clear();
+
+    // every new thread took over the cache of the previous one, which already had the block
+    CHECK_EQ(upstream.allocations.load(), 1);
+}
@@ -0,0 +1,51 @@
+#include <doctest/doctest.h>
+#include <thread_pool/statistics.h>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Ensure latency_histogram buckets durations by powers of two") {
+    using histogram = dp::latency_histogram;
+    CHECK_EQ(histogram::bucket_of(0ns), 0);
+    CHECK_EQ(histogram::bucket_of(-5ns), 0);
+    CHECK_EQ(histogram::bucket_of(1ns), 1);
+    CHECK_EQ(histogram::bucket_of(2ns), 2);
+    CHECK_EQ(histogram::bucket_of(3ns), 2);
+    CHECK_EQ(histogram::bucket_of(4ns), 3);
+    CHECK_EQ(histogram::bucket_of(1024ns), 11);
+    CHECK_EQ(histogram::bucket_of(std::chrono::hours(10000)), histogram::bucket_count - 1);
+}
+
+TEST_CASE("Ensure latency_histogram percentiles return the upper bound of the bucket") {
+    dp::latency_histogram histogram;
+    CHECK_EQ(histogram.count(), 0);
+    CHECK_EQ(histogram.percentile(0.5), 0ns);
+
+    // 90 durations in [512ns, 1024ns) and 10 in [65536ns, 131072ns)
+    histogram.buckets[dp::latency_histogram::bucket_of(600ns)] = 90;
+    histogram.buckets[dp::latency_histogram::bucket_of(100us)] = 10;
+    CHECK_EQ(histogram.count(), 100);
+    CHECK_EQ(histogram.percentile(0.0), 1024ns);
+    CHECK_EQ(histogram.percentile(0.5), 1024ns);
+    CHECK_EQ(histogram.percentile(0.95), 131072ns);
+    CHECK_EQ(histogram.percentile(1.0), 131072ns);
+}
+
+TEST_CASE("Ensure worker statistics add up") {
+    dp::thread_pool_statistics stats;
+    stats.workers.resize(3);
+    for (std::size_t i = 0; i < stats.workers.size(); ++i) {
+        auto &worker = stats.workers[i];
+        worker.tasks_executed = i + 1;
+        worker.tasks_stolen = 1;
+        worker.busy_time = 10ms;
+        worker.start_latency.buckets[4] = 2;
+    }
+
+    const auto total = stats.total();
+    CHECK_EQ(total.tasks_executed, 6);
+    CHECK_EQ(total.tasks_stolen, 3);
+    CHECK_EQ(total.busy_time, 30ms);
+    CHECK_EQ(total.start_latency.count(), 6);
+}
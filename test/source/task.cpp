@@ -0,0 +1,142 @@
+#include <doctest/doctest.h>
+#include <thread_pool/task.h>
+#include <thread_pool/thread_pool.h>
+#include <thread_pool/thread_safe_queue.h>
+#include <thread_pool/work_stealing_deque.h>
+
+#include <atomic>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Forwards to the default resource and counts the allocations.
+     */
+    class counting_resource : public std::pmr::memory_resource {
+      public:
+        std::atomic_size_t allocations{0};
+
+      protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            allocations.fetch_add(1);
+            return std::pmr::get_default_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+        }
+        [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    dp::task<std::thread::id> worker_id(dp::thread_pool<> &pool) {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+
+    dp::task<int> square(dp::thread_pool<> &pool, int value) {
+        co_await pool.schedule();
+        co_return value * value;
+    }
+
+    dp::task<int> sum_of_squares(dp::thread_pool<> &pool, int count) {
+        auto sum = 0;
+        for (auto i = 0; i < count; ++i) sum += co_await square(pool, i);
+        co_return sum;
+    }
+
+    dp::task<void> fail(dp::thread_pool<> &pool) {
+        co_await pool.schedule();
+        throw std::runtime_error("error");
+    }
+
+    dp::task<int &> reference(int &value) { co_return value; }
+}  // namespace
+
+TEST_CASE("Ensure schedule() resumes the coroutine on a worker") {
+    dp::thread_pool pool(2);
+    const auto id = dp::sync_wait(worker_id(pool));
+    CHECK_NE(id, std::this_thread::get_id());
+}
+
+TEST_CASE("Ensure schedule() continues inline on a pool without workers") {
+    dp::thread_pool pool(0);
+    // the coroutine would never be resumed if it was suspended
+    CHECK_EQ(dp::sync_wait(worker_id(pool)), std::this_thread::get_id());
+}
+
+TEST_CASE("Ensure dp::task returns values, references and exceptions") {
+    dp::thread_pool pool(2);
+    CHECK_EQ(dp::sync_wait(sum_of_squares(pool, 10)), 285);
+    CHECK_THROWS_AS(dp::sync_wait(fail(pool)), std::runtime_error);
+
+    int value = 1;
+    dp::sync_wait(reference(value)) = 2;
+    CHECK_EQ(value, 2);
+
+    auto lazy = square(pool, 3);
+    CHECK(lazy.valid());
+    CHECK_FALSE(lazy.is_ready());
+    CHECK_EQ(dp::sync_wait(std::move(lazy)), 9);
+}
+
+TEST_CASE("Ensure many coroutines can run on the pool at once") {
+    dp::thread_pool pool(4);
+    std::atomic_int counter{0};
+    auto increment = [](dp::thread_pool<> &target, std::atomic_int &count) -> dp::task<void> {
+        for (auto i = 0; i < 10; ++i) {
+            co_await target.schedule();
+            count.fetch_add(1);
+        }
+    };
+
+    std::vector<dp::future<void>> done;
+    for (auto i = 0; i < 100; ++i) {
+        done.push_back(pool.enqueue<dp::future>(
+            [&] { dp::sync_wait(increment(pool, counter)); }));
+    }
+    for (auto &future : done) future.get();
+    CHECK_EQ(counter.load(), 1000);
+}
+
+TEST_CASE("Ensure schedule() works with priorities and other queue types") {
+    using function_type = dp::details::default_function_type;
+    dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>> pool(2);
+    std::atomic_int counter{0};
+    auto hop = [](auto &target, std::atomic_int &count, dp::priority priority) -> dp::task<void> {
+        co_await target.schedule(priority);
+        count.fetch_add(1);
+    };
+
+    for (auto priority : {dp::priority::high, dp::priority::normal, dp::priority::low}) {
+        for (auto i = 0; i < 10; ++i) {
+            pool.enqueue_detach(
+                [&, priority] { dp::sync_wait(hop(pool, counter, priority)); });
+        }
+    }
+    // the resumed coroutines are tasks of the pool as well
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 30);
+}
+
+TEST_CASE("Ensure schedule() does not allocate per resumption") {
+    using function_type = dp::details::default_function_type;
+    // not constructible from a memory resource, so only task closures use the resource of the
+    // pool (if the function type allocates them there)
+    struct closure_counting_queue : dp::thread_safe_queue<function_type> {};
+    constexpr auto hops = 4'096;
+
+    counting_resource resource;
+    dp::thread_pool<function_type, std::jthread, closure_counting_queue> pool(
+        dp::thread_pool_options{.thread_count = 1, .memory_resource = &resource});
+    auto hop = [](auto &target) -> dp::task<void> {
+        for (auto i = 0; i < hops; ++i) co_await target.schedule();
+    };
+    dp::sync_wait(hop(pool));
+    // also with statistics enabled, which sample some of the tasks
+    CHECK_EQ(resource.allocations.load(), 0);
+}
@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+#include <thread_pool/task_graph.h>
+#include <thread_pool/thread_pool.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ensure task_graph runs tasks after their dependencies") {
+    dp::thread_pool pool(4);
+    dp::task_graph graph;
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&mutex, &order](std::string name) {
+        std::scoped_lock lock(mutex);
+        order.push_back(std::move(name));
+    };
+
+    auto load = graph.emplace(record, "load");
+    auto left = graph.emplace(record, "left");
+    auto right = graph.emplace(record, "right");
+    auto merge = graph.emplace(record, "merge");
+    load.precede(left, right);
+    merge.succeed(left, right);
+    CHECK_EQ(graph.size(), 4);
+
+    for (auto run = 0; run < 3; ++run) {
+        order.clear();
+        graph.run(pool).get();
+
+        REQUIRE_EQ(order.size(), 4);
+        CHECK_EQ(order.front(), "load");
+        CHECK_EQ(order.back(), "merge");
+    }
+}
+
+TEST_CASE("Ensure task_graph completes deep and wide graphs") {
+    dp::thread_pool pool(4);
+    dp::task_graph graph;
+    std::atomic_int counter{0};
+
+    // a chain of fan-outs and fan-ins
+    auto previous = graph.emplace([&counter] { counter.fetch_add(1); });
+    for (auto level = 0; level < 20; ++level) {
+        auto join = graph.emplace([&counter] { counter.fetch_add(1); });
+        for (auto i = 0; i < 10; ++i) {
+            auto task = graph.emplace([&counter] { counter.fetch_add(1); });
+            previous.precede(task);
+            join.succeed(task);
+        }
+        previous = join;
+    }
+
+    graph.run(pool).get();
+    CHECK_EQ(counter.load(), static_cast<int>(graph.size()));
+}
+
+TEST_CASE("Ensure task_graph skips remaining tasks after an exception") {
+    dp::thread_pool pool(2);
+    dp::task_graph graph;
+    std::atomic_int counter{0};
+    auto first = graph.emplace([] { throw std::runtime_error("error"); });
+    auto second = graph.emplace([&counter] { counter.fetch_add(1); });
+    first.precede(second);
+
+    CHECK_THROWS_AS(graph.run(pool).get(), std::runtime_error);
+    CHECK_EQ(counter.load(), 0);
+}
+
+TEST_CASE("Ensure task_graph fails when a task is cleared from the pool") {
+    dp::thread_pool pool(1);
+    std::atomic_bool started{false};
+    std::atomic_bool release{false};
+    pool.enqueue_detach([&started, &release] {
+        started.store(true);
+        while (!release.load()) std::this_thread::yield();
+    });
+    while (!started.load()) std::this_thread::yield();
+
+    std::atomic_int runs{0};
+    dp::task_graph graph;
+    auto first = graph.emplace([&runs] { runs.fetch_add(1); });
+    auto second = graph.emplace([&runs] { runs.fetch_add(1); });
+    first.precede(second);
+    auto result = graph.run(pool);
+    CHECK_EQ(pool.clear_tasks(), 1);
+    release.store(true);
+
+    try {
+        result.get();
+        FAIL("the run should fail");
+    } catch (const std::future_error& error) {
+        CHECK_EQ(error.code(), std::future_errc::broken_promise);
+    }
+    CHECK_EQ(runs.load(), 0);
+}
+
+TEST_CASE("Ensure task_graph ignores the overflow policy of a bounded pool") {
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 2, .queue_capacity = 2, .overflow = dp::overflow_policy::fail});
+    dp::task_graph graph;
+    std::atomic_int counter{0};
+    auto last = graph.emplace([&counter] { counter.fetch_add(1); });
+    for (auto i = 0; i < 20; ++i) {
+        graph.emplace([&counter] { counter.fetch_add(1); }).precede(last);
+    }
+
+    graph.run(pool).get();
+    CHECK_EQ(counter.load(), 21);
+}
+
+TEST_CASE("Ensure task_graph rejects cycles") {
+    dp::thread_pool pool(2);
+    dp::task_graph graph;
+    auto first = graph.emplace([] {});
+    auto second = graph.emplace([] {});
+    auto third = graph.emplace([] {});
+    first.precede(second);
+    second.precede(third);
+    third.precede(second);
+
+    CHECK_THROWS_AS(std::ignore = graph.run(pool), std::invalid_argument);
+
+    dp::task_graph empty;
+    CHECK(empty.run(pool).is_ready());
+}
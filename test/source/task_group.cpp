@@ -0,0 +1,214 @@
+#include <doctest/doctest.h>
+#include <thread_pool/parallel.h>
+#include <thread_pool/task_group.h>
+#include <thread_pool/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ensure task_group waits for all of its tasks") {
+    dp::thread_pool pool(4);
+    dp::task_group group(pool);
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 1'000; ++i) {
+        group.run([&counter] {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            counter.fetch_add(1);
+        });
+    }
+    group.wait();
+    CHECK_EQ(counter.load(), 1'000);
+    CHECK_EQ(group.pending(), 0);
+}
+
+TEST_CASE("Ensure task_group passes arguments and ignores return values") {
+    dp::thread_pool pool(2);
+    dp::task_group group(pool);
+    std::atomic_int sum{0};
+    for (auto i = 1; i <= 10; ++i) {
+        group.run(
+            [&sum](int value) {
+                sum.fetch_add(value);
+                return value;
+            },
+            i);
+    }
+    group.run(dp::priority::high, [&sum] { sum.fetch_add(100); });
+    group.wait();
+    CHECK_EQ(sum.load(), 155);
+}
+
+TEST_CASE("Ensure task_group only waits for its own tasks") {
+    dp::thread_pool pool(2);
+    std::atomic_bool release{false};
+    // unrelated work that keeps running until the group is done
+    pool.enqueue_detach([&release] {
+        while (!release.load()) std::this_thread::yield();
+    });
+
+    std::atomic_int counter{0};
+    {
+        dp::task_group group(pool);
+        for (auto i = 0; i < 100; ++i) group.run([&counter] { counter.fetch_add(1); });
+        group.wait();
+        CHECK_EQ(counter.load(), 100);
+    }
+
+    release.store(true);
+    pool.wait_for_tasks();
+}
+
+TEST_CASE("Ensure independent task_groups can share a pool") {
+    dp::thread_pool pool(4);
+    std::vector<std::jthread> callers;
+    std::atomic_int failures{0};
+    for (auto c = 0; c < 4; ++c) {
+        callers.emplace_back([&pool, &failures] {
+            for (auto request = 0; request < 50; ++request) {
+                dp::task_group group(pool);
+                std::atomic_int counter{0};
+                for (auto i = 0; i < 20; ++i) group.run([&counter] { counter.fetch_add(1); });
+                group.wait();
+                if (counter.load() != 20) failures.fetch_add(1);
+            }
+        });
+    }
+    callers.clear();
+    CHECK_EQ(failures.load(), 0);
+}
+
+TEST_CASE("Ensure a canceled task_group skips tasks that haven't started") {
+    dp::thread_pool pool(1);
+    dp::task_group group(pool);
+    std::atomic_bool started{false};
+    std::atomic_bool release{false};
+    std::atomic_int counter{0};
+
+    group.run([&] {
+        started.store(true);
+        while (!release.load()) std::this_thread::yield();
+    });
+    while (!started.load()) std::this_thread::yield();
+    for (auto i = 0; i < 10; ++i) group.run([&counter] { counter.fetch_add(1); });
+
+    group.cancel();
+    CHECK(group.is_canceled());
+    release.store(true);
+    group.wait();
+    CHECK_EQ(counter.load(), 0);
+
+    // the group can be reused after waiting
+    CHECK_FALSE(group.is_canceled());
+    group.run([&counter] { counter.fetch_add(1); });
+    group.wait();
+    CHECK_EQ(counter.load(), 1);
+}
+
+TEST_CASE("Ensure task_group rethrows the first exception") {
+    dp::thread_pool pool(1);
+    dp::task_group group(pool);
+    std::atomic_int counter{0};
+    group.run([] { throw std::runtime_error("first"); });
+    for (auto i = 0; i < 10; ++i) group.run([&counter] { counter.fetch_add(1); });
+
+    CHECK_THROWS_AS(group.wait(), std::runtime_error);
+    // the remaining tasks were canceled by the exception
+    CHECK_EQ(counter.load(), 0);
+
+    // the exception is only thrown once
+    CHECK_NOTHROW(group.wait());
+}
+
+TEST_CASE("Ensure task_group waits on destruction") {
+    dp::thread_pool pool(2);
+    std::atomic_int counter{0};
+    {
+        dp::task_group group(pool);
+        for (auto i = 0; i < 100; ++i) {
+            group.run([&counter] {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                counter.fetch_add(1);
+            });
+        }
+    }
+    CHECK_EQ(counter.load(), 100);
+}
+
+TEST_CASE("Ensure task_group doesn't wait for tasks cleared from the pool") {
+    dp::thread_pool pool(1);
+    std::atomic_bool started{false};
+    std::atomic_bool release{false};
+    pool.enqueue_detach([&started, &release] {
+        started.store(true);
+        while (!release.load()) std::this_thread::yield();
+    });
+    while (!started.load()) std::this_thread::yield();
+
+    std::atomic_int counter{0};
+    dp::task_group group(pool);
+    for (auto i = 0; i < 10; ++i) group.run([&counter] { counter.fetch_add(1); });
+    CHECK_EQ(group.pending(), 10);
+    CHECK_EQ(pool.clear_tasks(), 10);
+    CHECK_EQ(group.pending(), 0);
+
+    release.store(true);
+    group.wait();
+    CHECK_EQ(counter.load(), 0);
+}
+
+TEST_CASE("Ensure nested task_groups don't run out of workers") {
+    dp::thread_pool pool(2);
+    std::atomic_int counter{0};
+    dp::task_group outer(pool);
+    for (auto i = 0; i < 8; ++i) {
+        outer.run([&pool, &counter] {
+            dp::task_group inner(pool);
+            for (auto j = 0; j < 8; ++j) inner.run([&counter] { counter.fetch_add(1); });
+            inner.wait();
+        });
+    }
+    outer.wait();
+    CHECK_EQ(counter.load(), 64);
+}
+
+TEST_CASE("Ensure parallel_for can be nested in pool tasks") {
+    for (const auto thread_count : {1U, 2U}) {
+        dp::thread_pool pool(thread_count);
+        std::atomic_int counter{0};
+        dp::task_group group(pool);
+        for (auto i = 0; i < 4; ++i) {
+            group.run([&pool, &counter] {
+                dp::parallel_for(pool, 0, 100, [&counter](int) { counter.fetch_add(1); }, 10);
+            });
+        }
+        group.wait();
+        CHECK_EQ(counter.load(), 400);
+    }
+}
+
+TEST_CASE("Ensure task_group passes its stop_token to tasks that take one") {
+    dp::thread_pool pool(2);
+    dp::task_group group(pool);
+    std::atomic_bool started{false};
+    std::atomic_int stopped{0};
+    group.run([&](const std::stop_token &token) {
+        started.store(true);
+        while (!token.stop_requested()) std::this_thread::yield();
+        stopped.fetch_add(1);
+    });
+    group.run([&stopped](std::stop_token, int value) { stopped.fetch_add(value); }, 10);
+    while (!started.load()) std::this_thread::yield();
+
+    group.cancel();
+    CHECK(group.get_stop_token().stop_requested());
+    group.wait();
+    // the running task was stopped, the other one was either skipped or ran before the cancel
+    CHECK((stopped.load() == 1 || stopped.load() == 11));
+
+    // the group gets a fresh token after waiting
+    CHECK_FALSE(group.get_stop_token().stop_requested());
+}
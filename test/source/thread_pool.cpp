@@ -7,12 +7,19 @@
 #include <array>
 #include <barrier>
 #include <chrono>
+#include <ctime>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <numeric>
 #include <random>
+#include <ranges>
 #include <shared_mutex>
+#include <stdexcept>
+#include <stop_token>
 #include <string>
 #include <thread>
+#include <vector>
 
 auto multiply(int a, int b) { return a * b; }
 
@@ -337,6 +344,28 @@ TEST_CASE("Recursive enqueue calls work correctly") {
     CHECK_EQ(expected_sum, counter.load());
 }
 
+TEST_CASE("Ensure tasks enqueued from a worker thread are executed") {
+    unsigned int thread_count = 0;
+    SUBCASE("with single thread") { thread_count = 1; }
+    SUBCASE("with multiple threads") { thread_count = 4; }
+
+    std::atomic_int counter = 0;
+    constexpr auto depth = 10;
+    {
+        dp::thread_pool pool(thread_count);
+        // builds a binary tree of tasks, every task is enqueued from within the pool
+        std::function<void(int)> spawn = [&](int level) {
+            counter.fetch_add(1);
+            if (level == 0) return;
+            pool.enqueue_detach(spawn, level - 1);
+            pool.enqueue_detach(spawn, level - 1);
+        };
+        pool.enqueue_detach(spawn, depth);
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), (1 << (depth + 1)) - 1);
+    }
+}
+
 void recursive_parallel_sort(int* begin, int* end, int split_level, dp::thread_pool<>& pool) {
     if (split_level < 2 || end - begin < 2) {
         std::sort(begin, end);
@@ -553,6 +582,92 @@ TEST_CASE("Ensure wait_for_tasks() can be called multiple times on the same pool
     CHECK(all_correct_count);
 }
 
+TEST_CASE("Ensure wait_for_tasks() can be called from multiple threads at once") {
+    std::atomic_int counter{0};
+    constexpr auto task_count = 10'000;
+    dp::thread_pool pool(4);
+
+    std::vector<std::jthread> producers;
+    for (auto p = 0; p < 4; ++p) {
+        producers.emplace_back([&pool, &counter] {
+            for (auto i = 0; i < task_count; ++i) {
+                pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+                if (i % 1'000 == 0) pool.wait_for_tasks();
+            }
+            pool.wait_for_tasks();
+        });
+    }
+    producers.clear();
+
+    // every producer waited for its own tasks (and possibly those of others) to complete
+    CHECK_EQ(counter.load(), 4 * task_count);
+}
+
+TEST_CASE("Ensure wait_for_tasks() can be called from a task") {
+    dp::thread_pool pool(1);
+    std::atomic_int counter{0};
+    std::atomic_int seen{-1};
+    pool.enqueue_detach([&pool, &counter, &seen] {
+        for (auto i = 0; i < 10; ++i) pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+        // the only worker runs the other tasks instead of waiting for itself
+        pool.wait_for_tasks();
+        seen.store(counter.load());
+    });
+    pool.wait_for_tasks();
+    CHECK_EQ(seen.load(), 10);
+}
+
+int parallel_fibonacci(int n, dp::thread_pool<>& pool) {
+    if (n < 2) return n;
+    auto first = pool.enqueue<dp::future>(parallel_fibonacci, n - 1, std::ref(pool));
+    auto second = pool.enqueue<dp::future>(parallel_fibonacci, n - 2, std::ref(pool));
+    return first.get() + second.get();
+}
+
+TEST_CASE("Ensure waiting on a dp::future from a task runs pending tasks") {
+    // every task waits on two nested tasks, which deadlocks unless waiting workers help
+    dp::thread_pool pool(2);
+    auto result = pool.enqueue<dp::future>(parallel_fibonacci, 15, std::ref(pool));
+    CHECK_EQ(result.get(), 610);
+}
+
+TEST_CASE("Ensure a worker waiting on a dp::future parks when there is nothing to run") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(1);
+    dp::promise<int> promise;
+    auto future = promise.get_future();
+    auto waiting = pool.enqueue<dp::future>([&future] { return future.get(); });
+
+    const auto cpu_start = std::clock();
+    // the only worker is waiting, it has to wake up to run the task that sets the value
+    std::jthread producer([&pool, &promise] {
+        std::this_thread::sleep_for(500ms);
+        pool.enqueue_detach([&promise] { promise.set_value(42); });
+    });
+    CHECK_EQ(waiting.get(), 42);
+    const auto cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    // a spinning worker would use a core for the whole 500ms
+    CHECK_LT(cpu_seconds, 0.1);
+}
+
+TEST_CASE("Ensure continuations run on the pool without blocking") {
+    dp::thread_pool pool(2);
+    auto result = pool.enqueue<dp::future>([] { return 1; })
+                      .then(pool, [](int value) { return value + 1; })
+                      .then(pool, [](int value) { return std::to_string(value); });
+
+    std::vector<dp::future<int>> parts;
+    for (auto i = 0; i < 10; ++i) parts.push_back(pool.enqueue<dp::future>([i] { return i; }));
+    auto sum = dp::when_all(std::move(parts)).then(pool, [](std::vector<dp::future<int>> ready) {
+        auto total = 0;
+        for (auto& part : ready) total += part.get();
+        return total;
+    });
+
+    CHECK_EQ(result.get(), "2");
+    CHECK_EQ(sum.get(), 45);
+}
+
 TEST_CASE("Initialization function is called") {
     std::atomic_int counter = 0;
     {
@@ -646,3 +761,735 @@ TEST_CASE("Check clear_tasks() clears tasks") {
     CHECK_EQ(cleared_tasks, static_cast<size_t>(thread_count));
     CHECK_EQ(thread_count, counter.load());
 }
+
+TEST_CASE("Ensure work completes with work_stealing_deque task queues") {
+    using function_type = dp::details::default_function_type;
+    using pool_type =
+        dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>>;
+
+    std::atomic_int counter = 0;
+    constexpr auto total_tasks = 1000;
+    {
+        pool_type pool(4);
+        std::vector<std::future<int>> futures;
+        for (auto i = 0; i < total_tasks; i++) {
+            pool.enqueue_detach([&counter]() { counter.fetch_add(1); });
+            futures.push_back(pool.enqueue([i]() { return i; }));
+        }
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), total_tasks);
+
+        for (auto j = 0; j < total_tasks; j++) {
+            CHECK_EQ(j, futures[j].get());
+        }
+    }
+}
+
+TEST_CASE("Ensure enqueue_bulk() returns a future for every task") {
+    unsigned int thread_count = 0;
+    SUBCASE("with single thread") { thread_count = 1; }
+    SUBCASE("with multiple threads") { thread_count = 4; }
+
+    dp::thread_pool pool(thread_count);
+    constexpr auto total_tasks = 1000;
+    auto futures = pool.enqueue_bulk(std::views::iota(0, total_tasks) |
+                                     std::views::transform([](int i) { return [i] { return i; }; }));
+    REQUIRE_EQ(futures.size(), total_tasks);
+    for (auto i = 0; i < total_tasks; ++i) {
+        CHECK_EQ(futures[i].get(), i);
+    }
+
+    // exceptions are forwarded to the future
+    std::vector<std::function<int()>> functions = {[] { return 1; },
+                                                   []() -> int { throw std::logic_error("error"); }};
+    auto results = pool.enqueue_bulk(functions);
+    CHECK_EQ(results[0].get(), 1);
+    CHECK_THROWS(results[1].get());
+}
+
+TEST_CASE("Ensure enqueue_detach_bulk() runs every task") {
+    unsigned int thread_count = 0;
+    SUBCASE("with single thread") { thread_count = 1; }
+    SUBCASE("with multiple threads") { thread_count = 4; }
+
+    std::atomic_int counter = 0;
+    constexpr auto total_tasks = 1000;
+    auto increment = [&counter] { counter.fetch_add(1); };
+    {
+        dp::thread_pool pool(thread_count);
+        pool.enqueue_detach_bulk(std::vector(total_tasks, increment));
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), total_tasks);
+
+        // also works when called from within the pool
+        pool.enqueue_detach([&pool, increment] {
+            pool.enqueue_detach_bulk(std::vector(total_tasks, increment));
+        });
+        // an empty range is a no-op
+        pool.enqueue_detach_bulk(std::vector<std::function<void()>>{});
+    }
+
+    CHECK_EQ(counter.load(), 2 * total_tasks);
+}
+
+TEST_CASE("Ensure enqueue() can return a dp::future") {
+    dp::thread_pool pool(4);
+    dp::future<int> future = pool.enqueue<dp::future>(multiply, 6, 7);
+    CHECK_EQ(future.get(), 42);
+
+    auto void_future = pool.enqueue<dp::future>([] {});
+    CHECK_NOTHROW(void_future.get());
+
+    auto throwing_future =
+        pool.enqueue<dp::future>([]() -> int { throw std::runtime_error("error"); });
+    CHECK_THROWS_AS(throwing_future.get(), std::runtime_error);
+
+    auto futures = pool.enqueue_bulk<dp::future>(
+        std::views::iota(0, 100) | std::views::transform([](int i) { return [i] { return i; }; }));
+    for (auto i = 0; i < 100; ++i) {
+        CHECK_EQ(futures[i].get(), i);
+    }
+}
+
+TEST_CASE("Ensure tasks can be allocated from a memory resource") {
+    dp::recycling_memory_resource resource;
+    constexpr auto total_tasks = 1000;
+    std::atomic_int counter{0};
+
+    auto run_tasks = [&](auto& pool) {
+        std::vector<std::future<int>> std_futures;
+        std::vector<dp::future<int>> dp_futures;
+        for (auto i = 0; i < total_tasks; ++i) {
+            std_futures.push_back(pool.enqueue([i] { return i; }));
+            dp_futures.push_back(pool.template enqueue<dp::future>([i] { return i; }));
+            pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+        }
+        pool.enqueue_detach_bulk(std::views::iota(0, total_tasks) |
+                                 std::views::transform([&counter](int) {
+                                     return [&counter] { counter.fetch_add(1); };
+                                 }));
+        for (auto i = 0; i < total_tasks; ++i) {
+            CHECK_EQ(std_futures[i].get(), i);
+            CHECK_EQ(dp_futures[i].get(), i);
+        }
+        pool.wait_for_tasks();
+    };
+
+    SUBCASE("with thread_safe_queue") {
+        dp::thread_pool pool({.thread_count = 4, .memory_resource = &resource});
+        run_tasks(pool);
+    }
+    SUBCASE("with work_stealing_deque") {
+        using function_type = dp::details::default_function_type;
+        dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>> pool(
+            {.thread_count = 4, .memory_resource = &resource});
+        run_tasks(pool);
+    }
+
+    CHECK_EQ(counter.load(), 2 * total_tasks);
+}
+
+TEST_CASE("Ensure work completes with a spinning idle strategy") {
+    dp::idle_strategy strategy{};
+    SUBCASE("spin") { strategy = {.spin_count = 10'000}; }
+    SUBCASE("yield") { strategy = {.yield_count = 100}; }
+    SUBCASE("spin and yield") { strategy = {.spin_count = 1'000, .yield_count = 10}; }
+
+    std::atomic_int counter{0};
+    constexpr auto total_tasks = 1000;
+    {
+        dp::thread_pool pool({.thread_count = 4, .idle = strategy});
+        for (int burst = 0; burst < 10; ++burst) {
+            for (auto i = 0; i < total_tasks / 10; ++i) {
+                pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        CHECK_EQ(pool.enqueue([] { return 42; }).get(), 42);
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), total_tasks);
+    }
+}
+
+TEST_CASE("Ensure tasks flooding a single worker are stolen in batches") {
+    using function_type = dp::details::default_function_type;
+    std::atomic_int counter{0};
+    constexpr auto total_tasks = 20'000;
+
+    auto flood = [&](auto& pool) {
+        // all tasks end up in the queue of the worker that runs the producer
+        pool.enqueue_detach([&pool, &counter] {
+            for (auto i = 0; i < total_tasks; ++i) {
+                pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+            }
+        });
+        pool.wait_for_tasks();
+    };
+
+    SUBCASE("with thread_safe_queue") {
+        dp::thread_pool pool(4);
+        flood(pool);
+    }
+    SUBCASE("with work_stealing_deque") {
+        dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>> pool(
+            4);
+        flood(pool);
+    }
+    CHECK_EQ(counter.load(), total_tasks);
+}
+
+TEST_CASE("Ensure higher priority tasks run first") {
+    using function_type = dp::details::default_function_type;
+    std::vector<dp::priority> order;
+
+    auto run = [&](auto& pool) {
+        // keep the only worker busy while the tasks are enqueued
+        std::atomic_bool started{false};
+        std::atomic_bool release{false};
+        pool.enqueue_detach([&started, &release] {
+            started.store(true);
+            while (!release.load()) std::this_thread::yield();
+        });
+        while (!started.load()) std::this_thread::yield();
+        for (const auto task_priority :
+             {dp::priority::low, dp::priority::normal, dp::priority::high, dp::priority::low,
+              dp::priority::high, dp::priority::normal}) {
+            pool.enqueue_detach(task_priority,
+                                [&order, task_priority] { order.push_back(task_priority); });
+        }
+        release.store(true);
+        pool.wait_for_tasks();
+    };
+
+    SUBCASE("with thread_safe_queue") {
+        dp::thread_pool pool(1);
+        run(pool);
+    }
+    SUBCASE("with work_stealing_deque") {
+        dp::thread_pool<function_type, std::jthread, dp::work_stealing_deque<function_type>> pool(
+            1);
+        run(pool);
+    }
+
+    const std::vector expected{dp::priority::high,   dp::priority::high, dp::priority::normal,
+                               dp::priority::normal, dp::priority::low,  dp::priority::low};
+    CHECK_EQ(order, expected);
+}
+
+TEST_CASE("Ensure priority aging lets lower priority tasks through") {
+    std::vector<int> order;
+    {
+        dp::thread_pool pool({.thread_count = 1, .priority_aging = 3});
+        std::atomic_bool started{false};
+        std::atomic_bool release{false};
+        pool.enqueue_detach([&started, &release] {
+            started.store(true);
+            while (!release.load()) std::this_thread::yield();
+        });
+        while (!started.load()) std::this_thread::yield();
+        pool.enqueue_detach(dp::priority::low, [&order] { order.push_back(-1); });
+        for (auto i = 0; i < 8; ++i) {
+            pool.enqueue_detach(dp::priority::high, [&order, i] { order.push_back(i); });
+        }
+        release.store(true);
+        pool.wait_for_tasks();
+    }
+
+    // the low priority task runs after 3 high priority ones instead of after all of them
+    const std::vector expected{0, 1, 2, -1, 3, 4, 5, 6, 7};
+    CHECK_EQ(order, expected);
+}
+
+TEST_CASE("Ensure enqueue() with a priority returns the result") {
+    dp::thread_pool pool(4);
+    auto high = pool.enqueue(dp::priority::high, [](int value) { return value * 2; }, 21);
+    auto low = pool.enqueue<dp::future>(dp::priority::low, [] { return 7; });
+    CHECK_EQ(high.get(), 42);
+    CHECK_EQ(low.get(), 7);
+
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 3'000; ++i) {
+        pool.enqueue_detach(static_cast<dp::priority>(i % 3), [&counter] { counter.fetch_add(1); });
+    }
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 3'000);
+}
+
+TEST_CASE("Ensure resize() adds and retires workers with tasks in flight") {
+    std::atomic_int initialized{0};
+    std::atomic_int counter{0};
+    {
+        dp::thread_pool pool(dp::thread_pool_options{.thread_count = 2, .max_thread_count = 6},
+                             [&initialized](std::size_t) { initialized.fetch_add(1); });
+        CHECK_EQ(pool.size(), 2);
+        CHECK_EQ(pool.max_size(), 6);
+
+        const auto flood = [&pool, &counter] {
+            for (auto i = 0; i < 2'000; ++i) {
+                pool.enqueue_detach([&counter] {
+                    std::this_thread::sleep_for(std::chrono::microseconds(5));
+                    counter.fetch_add(1);
+                });
+            }
+        };
+
+        flood();
+        pool.resize(6);
+        CHECK_EQ(pool.size(), 6);
+        flood();
+        // retired workers leave their queued tasks behind for the others
+        pool.resize(1);
+        CHECK_EQ(pool.size(), 1);
+        flood();
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), 6'000);
+
+        pool.resize(3);
+        auto future = pool.enqueue([] { return 42; });
+        CHECK_EQ(future.get(), 42);
+    }
+    // workers started later are initialized as well
+    CHECK_EQ(initialized.load(), 8);
+}
+
+TEST_CASE("Ensure resize() does not wait for the queues of retired workers to drain") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(4);
+    std::atomic_bool done{false};
+    std::atomic_int pending{0};
+
+    // keep every worker busy with a backlog for as long as the test runs
+    std::vector<std::jthread> producers;
+    for (auto i = 0; i < 2; ++i) {
+        producers.emplace_back([&pool, &done, &pending] {
+            const auto deadline = std::chrono::steady_clock::now() + 10s;
+            while (!done.load() && std::chrono::steady_clock::now() < deadline) {
+                if (pending.load() > 256) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                pending.fetch_add(1);
+                pool.enqueue_detach([&pending] {
+                    std::this_thread::sleep_for(20us);
+                    pending.fetch_sub(1);
+                });
+            }
+        });
+    }
+    std::this_thread::sleep_for(50ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.resize(1);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    done.store(true);
+    producers.clear();
+
+    CHECK_EQ(pool.size(), 1);
+    CHECK_LT(elapsed, 2s);
+    pool.wait_for_tasks();
+    CHECK_EQ(pending.load(), 0);
+}
+
+TEST_CASE("Ensure resize() is clamped and rejected from tasks") {
+    dp::thread_pool pool(dp::thread_pool_options{.thread_count = 2});
+    pool.resize(100);
+    CHECK_EQ(pool.size(), 2);
+    pool.resize(0);
+    CHECK_EQ(pool.size(), 1);
+
+    auto resized = pool.enqueue([&pool] { pool.resize(2); });
+    CHECK_THROWS_AS(resized.get(), std::logic_error);
+}
+
+TEST_CASE("Ensure a pool without workers can be resized") {
+    dp::thread_pool pool(0);
+    CHECK_EQ(pool.size(), 0);
+    CHECK_EQ(pool.max_size(), 1);
+    pool.resize(4);
+    CHECK_EQ(pool.size(), 1);
+    CHECK_EQ(pool.enqueue([] { return 3; }).get(), 3);
+}
+
+TEST_CASE("Ensure inconsistent autoscaling bounds are normalized") {
+    using namespace std::chrono_literals;
+    // the minimum is larger than the maximum number of workers
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 1,
+        .max_thread_count = 2,
+        .autoscaling = {.enabled = true, .min_threads = 4, .max_threads = 2, .interval = 1ms}});
+    CHECK_EQ(pool.max_size(), 2);
+    CHECK_EQ(pool.size(), 2);
+    std::this_thread::sleep_for(10ms);
+    CHECK_EQ(pool.size(), 2);
+
+    // a maximum of 0 workers
+    dp::thread_pool minimal(dp::thread_pool_options{
+        .thread_count = 0, .autoscaling = {.enabled = true, .max_threads = 0}});
+    CHECK_EQ(minimal.max_size(), 1);
+    CHECK_EQ(minimal.size(), 1);
+    CHECK_EQ(minimal.enqueue([] { return 3; }).get(), 3);
+}
+
+TEST_CASE("Ensure the autoscaler grows under load and shrinks when idle") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 1,
+        .autoscaling = {.enabled = true,
+                        .min_threads = 1,
+                        .max_threads = 4,
+                        .queue_depth = 2,
+                        .idle_time = 20ms,
+                        .interval = 5ms}});
+    CHECK_EQ(pool.size(), 1);
+
+    std::atomic_bool release{false};
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 100; ++i) {
+        pool.enqueue_detach([&release, &counter] {
+            while (!release.load()) std::this_thread::sleep_for(100us);
+            counter.fetch_add(1);
+        });
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (pool.size() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    CHECK_EQ(pool.size(), 4);
+
+    release.store(true);
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 100);
+
+    while (pool.size() > 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    CHECK_EQ(pool.size(), 1);
+}
+
+TEST_CASE("Ensure enqueue_after() and enqueue_at() run tasks once their time has come") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(1);
+    const auto start = std::chrono::steady_clock::now();
+    std::promise<std::chrono::steady_clock::time_point> after;
+    std::promise<std::chrono::steady_clock::time_point> at;
+    std::ignore = pool.enqueue_after(30ms, [&after] {
+        after.set_value(std::chrono::steady_clock::now());
+    });
+    std::ignore = pool.enqueue_at(std::chrono::system_clock::now() + 20ms, [&at] {
+        at.set_value(std::chrono::steady_clock::now());
+    });
+
+    // the pending timers don't occupy the only worker
+    auto other = pool.enqueue([] { return 42; });
+    CHECK_EQ(other.get(), 42);
+
+    CHECK_GE(after.get_future().get() - start, 30ms);
+    CHECK_GE(at.get_future().get() - start, 19ms);
+}
+
+TEST_CASE("Ensure many timers are handed to the workers") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(4);
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 1'000; ++i) {
+        const auto canceled = i % 10 == 0;
+        auto handle = pool.enqueue_after(std::chrono::milliseconds(i % 20 + (canceled ? 50 : 0)),
+                                         [&counter](int value) { counter.fetch_add(value); }, 1);
+        if (canceled) {
+            handle.cancel();
+            CHECK(handle.is_canceled());
+        }
+    }
+
+    const auto deadline = start + 10s;
+    while (counter.load() < 900 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    // the canceled timers expire in the meantime
+    std::this_thread::sleep_until(std::max(std::chrono::steady_clock::now(), start + 100ms));
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 900);
+}
+
+TEST_CASE("Ensure canceled timers release their task right away") {
+    dp::thread_pool pool(1);
+    auto captured = std::make_shared<int>(0);
+    std::vector<dp::timer_handle> timers;
+    for (auto i = 0; i < 1'000; ++i) {
+        timers.push_back(pool.enqueue_after(std::chrono::hours(1), [captured] {}));
+    }
+    CHECK_EQ(captured.use_count(), 1'001);
+    CHECK_EQ(pool.stats().pending_timers, 1'000);
+
+    for (const auto &timer : timers) timer.cancel();
+    // the captures are not kept alive until the deadline
+    CHECK_EQ(captured.use_count(), 1);
+    CHECK_EQ(pool.stats().pending_timers, 0);
+
+    // canceling a timer twice or after it expired doesn't count it again
+    timers.front().cancel();
+    auto expired = pool.enqueue_after(std::chrono::milliseconds(1), [] {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pool.wait_for_tasks();
+    expired.cancel();
+    auto pending = pool.enqueue_after(std::chrono::hours(1), [] {});
+    CHECK_EQ(pool.stats().pending_timers, 1);
+}
+
+TEST_CASE("Ensure enqueue_every() repeats until canceled") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(2);
+    std::atomic_int runs{0};
+    const auto timer = pool.enqueue_every(2ms, [&runs] { runs.fetch_add(1); });
+    CHECK(timer.valid());
+
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (runs.load() < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    CHECK_GE(runs.load(), 5);
+
+    timer.cancel();
+    std::this_thread::sleep_for(10ms);
+    pool.wait_for_tasks();
+    const auto stopped = runs.load();
+    std::this_thread::sleep_for(20ms);
+    CHECK_EQ(runs.load(), stopped);
+}
+
+namespace {
+    /**
+     * @brief Occupy the only worker of @p pool until @p release is set.
+     */
+    template <typename Pool>
+    void occupy_worker(Pool &pool, std::atomic_bool &release) {
+        std::atomic_bool started{false};
+        pool.enqueue_detach([&started, &release] {
+            started.store(true);
+            while (!release.load()) std::this_thread::yield();
+        });
+        while (!started.load()) std::this_thread::yield();
+    }
+}  // namespace
+
+TEST_CASE("Ensure try_enqueue() fails once a bounded pool is full") {
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 1, .queue_capacity = 4, .overflow = dp::overflow_policy::fail});
+    std::atomic_bool release{false};
+    std::atomic_int counter{0};
+    occupy_worker(pool, release);
+
+    for (auto i = 0; i < 3; ++i) CHECK(pool.try_enqueue_detach([&counter] { counter++; }));
+    auto last = pool.try_enqueue([] { return 42; });
+    REQUIRE(last.has_value());
+    CHECK_FALSE(pool.try_enqueue_detach([&counter] { counter++; }));
+    CHECK_FALSE(pool.try_enqueue([] { return 0; }).has_value());
+    CHECK_THROWS_AS(pool.enqueue_detach([&counter] { counter++; }), dp::queue_full_error);
+
+    release.store(true);
+    CHECK_EQ(last->get(), 42);
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 3);
+    // started tasks free up their slots
+    CHECK(pool.try_enqueue_detach([&counter] { counter++; }));
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 4);
+}
+
+TEST_CASE("Ensure a full pool can run tasks on the calling thread") {
+    dp::thread_pool pool(dp::thread_pool_options{
+        .thread_count = 1, .queue_capacity = 2, .overflow = dp::overflow_policy::caller_runs});
+    std::atomic_bool release{false};
+    occupy_worker(pool, release);
+
+    std::vector<std::future<std::thread::id>> ids;
+    for (auto i = 0; i < 4; ++i) {
+        ids.push_back(pool.enqueue([] { return std::this_thread::get_id(); }));
+    }
+    // the last two didn't fit and already ran here
+    CHECK_EQ(ids[2].get(), std::this_thread::get_id());
+    CHECK_EQ(ids[3].get(), std::this_thread::get_id());
+
+    release.store(true);
+    CHECK_NE(ids[0].get(), std::this_thread::get_id());
+    CHECK_NE(ids[1].get(), std::this_thread::get_id());
+}
+
+TEST_CASE("Ensure a full pool blocks producers until there is room") {
+    using namespace std::chrono_literals;
+    dp::thread_pool pool(dp::thread_pool_options{.thread_count = 1, .queue_capacity = 2});
+    std::atomic_bool release{false};
+    std::atomic_int counter{0};
+    occupy_worker(pool, release);
+
+    std::atomic_bool enqueued{false};
+    std::jthread producer([&] {
+        for (auto i = 0; i < 3; ++i) pool.enqueue_detach([&counter] { counter++; });
+        enqueued.store(true);
+    });
+    std::this_thread::sleep_for(20ms);
+    CHECK_FALSE(enqueued.load());
+
+    release.store(true);
+    producer.join();
+    CHECK(enqueued.load());
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 3);
+}
+
+TEST_CASE("Ensure blocked workers of a bounded pool don't deadlock") {
+    dp::thread_pool pool(dp::thread_pool_options{.thread_count = 2, .queue_capacity = 4});
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 16; ++i) {
+        pool.enqueue_detach([&pool, &counter] {
+            // every task adds more tasks than there is room for
+            for (auto j = 0; j < 16; ++j) pool.enqueue_detach([&counter] { counter++; });
+        });
+    }
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 256);
+
+    // bulk enqueues larger than the capacity get through once the queues are empty
+    std::vector<std::function<void()>> tasks(10, [&counter] { counter++; });
+    pool.enqueue_detach_bulk(tasks);
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 266);
+}
+
+TEST_CASE("Ensure tasks canceled through their stop_token are dropped") {
+    dp::thread_pool pool(1);
+    std::atomic_bool release{false};
+    occupy_worker(pool, release);
+
+    std::stop_source source;
+    std::atomic_int counter{0};
+    for (auto i = 0; i < 10; ++i) {
+        pool.enqueue_detach(source.get_token(), [&counter](std::stop_token) { counter++; });
+    }
+    auto canceled = pool.enqueue(
+        source.get_token(), [](std::stop_token, int value) { return value; }, 42);
+    // tasks with another token are not affected
+    std::stop_source other;
+    auto kept = pool.enqueue<dp::future>(
+        other.get_token(), [](const std::stop_token &token) { return !token.stop_requested(); });
+
+    source.request_stop();
+    // already canceled tasks are not even queued
+    pool.enqueue_detach(source.get_token(), [&counter](std::stop_token) { counter++; });
+    release.store(true);
+
+    CHECK_THROWS_AS(canceled.get(), dp::task_canceled_error);
+    CHECK(kept.get());
+    pool.wait_for_tasks();
+    CHECK_EQ(counter.load(), 0);
+}
+
+TEST_CASE("Ensure running tasks see stop requests") {
+    dp::thread_pool pool(2);
+    std::stop_source source;
+    std::atomic_bool started{false};
+    auto result = pool.enqueue(source.get_token(), [&started](const std::stop_token &token) {
+        started.store(true);
+        auto iterations = 0;
+        while (!token.stop_requested()) {
+            ++iterations;
+            std::this_thread::yield();
+        }
+        return iterations;
+    });
+    while (!started.load()) std::this_thread::yield();
+    source.request_stop();
+    CHECK_GE(result.get(), 0);
+}
+
+TEST_CASE("Ensure tasks taking a stop_token receive the token of the pool") {
+    dp::thread_pool pool(1);
+    std::atomic_bool release{false};
+    occupy_worker(pool, release);
+
+    std::atomic_int with_token{0};
+    std::atomic_int without_token{0};
+    auto first = pool.enqueue([](std::stop_token token) { return token.stop_possible(); });
+    for (auto i = 0; i < 10; ++i) {
+        pool.enqueue_detach([&with_token](std::stop_token, int value) { with_token += value; }, 1);
+        pool.enqueue_detach([&without_token] { without_token++; });
+    }
+
+    CHECK(pool.request_stop());
+    CHECK(pool.get_stop_token().stop_requested());
+    release.store(true);
+    pool.wait_for_tasks();
+
+    CHECK_THROWS_AS(first.get(), dp::task_canceled_error);
+    CHECK_EQ(with_token.load(), 0);
+    CHECK_EQ(without_token.load(), 10);
+}
+
+TEST_CASE("Ensure stats() counts executed tasks") {
+    constexpr auto task_count = 1000;
+    dp::thread_pool pool(4);
+    for (auto i = 0; i < task_count; ++i) pool.enqueue_detach([] {});
+    pool.wait_for_tasks();
+
+    const auto stats = pool.stats();
+    CHECK_EQ(stats.workers.size(), 4);
+    CHECK_EQ(stats.queued_tasks, 0);
+    CHECK_EQ(stats.in_flight_tasks, 0);
+
+    const auto total = stats.total();
+    CHECK_EQ(total.tasks_executed, task_count);
+    CHECK_EQ(total.queue_depth, 0);
+    CHECK_EQ(total.tasks_stolen, total.stolen_from);
+    if constexpr (dp::details::collect_statistics) {
+        // one in 64 tasks is sampled per enqueuing thread
+        CHECK_GE(total.start_latency.count(), task_count / dp::details::latency_sample_period);
+        CHECK_LE(total.start_latency.count(),
+                 task_count / dp::details::latency_sample_period + 1);
+        CHECK_GT(total.busy_time.count(), 0);
+    } else {
+        CHECK_EQ(total.start_latency.count(), 0);
+    }
+}
+
+TEST_CASE("Ensure stats() reports queued tasks and timers") {
+    dp::thread_pool pool(1);
+    std::atomic_bool release{false};
+    occupy_worker(pool, release);
+    for (auto i = 0; i < 5; ++i) pool.enqueue_detach([] {});
+    auto timer = pool.enqueue_after(std::chrono::hours(1), [] {});
+
+    auto stats = pool.stats();
+    CHECK_EQ(stats.workers.size(), 1);
+    CHECK_EQ(stats.queued_tasks, 5);
+    CHECK_EQ(stats.in_flight_tasks, 6);
+    CHECK_EQ(stats.pending_timers, 1);
+    CHECK_EQ(stats.workers.front().queue_depth, 5);
+
+    timer.cancel();
+    release.store(true);
+    pool.wait_for_tasks();
+    stats = pool.stats();
+    CHECK_EQ(stats.queued_tasks, 0);
+    CHECK_EQ(stats.total().tasks_executed, 6);
+}
+
+TEST_CASE("Ensure stats() counts steals") {
+    constexpr auto task_count = 100;
+    dp::thread_pool pool(2);
+    std::atomic_int executed{0};
+    pool.enqueue_detach([&pool, &executed] {
+        // tasks enqueued from a worker go to its own queue and it doesn't run them itself, so
+        // the other worker has to steal every one of them, a batch at a time
+        for (auto i = 0; i < task_count; ++i) pool.enqueue_detach([&executed] { executed++; });
+        while (executed.load() < task_count) std::this_thread::yield();
+    });
+    pool.wait_for_tasks();
+
+    const auto total = pool.stats().total();
+    CHECK_EQ(total.tasks_executed, task_count + 1);
+    if constexpr (dp::details::collect_statistics) {
+        CHECK_GE(total.tasks_stolen, task_count);
+        CHECK_EQ(total.tasks_stolen, total.stolen_from);
+    }
+}
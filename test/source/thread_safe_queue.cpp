@@ -1,9 +1,11 @@
 #include <doctest/doctest.h>
 #include <thread_pool/thread_safe_queue.h>
 
+#include <atomic>
 #include <barrier>
 #include <future>
 #include <thread>
+#include <vector>
 
 TEST_CASE("Ensure insert and pop works with thread contention") {
     // create a synchronization barrier to ensure our threads have started before executing code to
@@ -86,3 +88,57 @@ TEST_CASE("Ensure clear() works and returns correct count") {
     CHECK(queue.empty());
     CHECK_EQ(removed_count, 3);
 }
+
+TEST_CASE("Ensure append_range() pushes all values in order") {
+    dp::thread_safe_queue<int> queue;
+    queue.push_back(0);
+    const std::vector values = {1, 2, 3, 4};
+    queue.append_range(values);
+
+    for (int i = 0; i <= 4; ++i) {
+        CHECK_EQ(queue.pop_front().value_or(-1), i);
+    }
+    CHECK(queue.empty());
+}
+
+TEST_CASE("Ensure steal_batch() steals half of the items") {
+    dp::thread_safe_queue<int> victim;
+    dp::thread_safe_queue<int> thief;
+    for (int i = 0; i < 9; ++i) victim.push_back(int(i));
+
+    // items are stolen from the back, the oldest stolen item is returned
+    std::size_t moved = 0;
+    CHECK_EQ(victim.steal_batch(thief, &moved).value_or(-1), 4);
+    CHECK_EQ(moved, 4);
+    for (int i = 5; i < 9; ++i) CHECK_EQ(thief.pop_front().value_or(-1), i);
+    CHECK(thief.empty());
+    for (int i = 0; i < 4; ++i) CHECK_EQ(victim.pop_front().value_or(-1), i);
+
+    CHECK_FALSE(victim.steal_batch(thief).has_value());
+    victim.push_back(42);
+    CHECK_EQ(victim.steal_batch(victim).value_or(-1), 42);
+}
+
+TEST_CASE("Ensure steal_batch() doesn't deadlock when queues steal from each other") {
+    dp::thread_safe_queue<int> first;
+    dp::thread_safe_queue<int> second;
+    constexpr auto item_count = 10'000;
+    for (int i = 0; i < item_count; ++i) first.push_back(int(i));
+
+    std::atomic_int taken{0};
+    {
+        std::jthread a([&] {
+            while (taken.load() < item_count) {
+                if (first.steal_batch(second)) taken.fetch_add(1);
+            }
+        });
+        std::jthread b([&] {
+            while (taken.load() < item_count) {
+                if (second.steal_batch(first)) taken.fetch_add(1);
+            }
+        });
+    }
+    CHECK_EQ(taken.load(), item_count);
+    CHECK(first.empty());
+    CHECK(second.empty());
+}
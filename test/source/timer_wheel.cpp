@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+#include <thread_pool/timer_wheel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+    using wheel_type = dp::details::timer_wheel<int>;
+
+    std::vector<std::uint64_t> deadlines(const std::vector<wheel_type::entry> &entries) {
+        std::vector<std::uint64_t> result;
+        for (const auto &entry : entries) result.push_back(entry.deadline);
+        return result;
+    }
+}  // namespace
+
+TEST_CASE("Ensure timer_wheel expires timers at their deadline") {
+    wheel_type wheel;
+    CHECK_FALSE(wheel.next_tick().has_value());
+
+    wheel.insert(5, 1);
+    wheel.insert(3, 2);
+    wheel.insert(5, 3);
+    CHECK_EQ(wheel.size(), 3);
+    CHECK_EQ(wheel.next_tick(), 3);
+
+    std::vector<wheel_type::entry> expired;
+    wheel.advance(2, expired);
+    CHECK(expired.empty());
+    wheel.advance(4, expired);
+    CHECK_EQ(deadlines(expired), std::vector<std::uint64_t>{3});
+    CHECK_EQ(expired.front().value, 2);
+
+    expired.clear();
+    wheel.advance(10, expired);
+    const std::vector<std::uint64_t> both{5, 5};
+    CHECK_EQ(deadlines(expired), both);
+    CHECK(wheel.empty());
+    CHECK_EQ(wheel.current(), 11);
+
+    // deadlines in the past expire with the next advance
+    wheel.insert(1, 4);
+    expired.clear();
+    wheel.advance(11, expired);
+    CHECK_EQ(deadlines(expired), std::vector<std::uint64_t>{11});
+}
+
+TEST_CASE("Ensure timer_wheel cascades far timers down the levels") {
+    wheel_type wheel(100);
+    std::vector<std::uint64_t> inserted{100 + 63,    100 + 64,       100 + 4'095,
+                                        100 + 4'096, 100 + 262'145, 100 + (1ULL << 36) + 7,
+                                        100 + (1ULL << 40)};
+    for (const auto deadline : inserted) wheel.insert(deadline, 0);
+
+    // advancing in big steps only visits the ticks where something happens
+    std::vector<wheel_type::entry> expired;
+    std::size_t steps = 0;
+    while (const auto next = wheel.next_tick()) {
+        CHECK_GE(*next, wheel.current());
+        wheel.advance(*next, expired);
+        ++steps;
+    }
+    CHECK_EQ(deadlines(expired), inserted);
+    CHECK_LT(steps, 200);
+}
+
+TEST_CASE("Ensure timer_wheel erases timers from all levels") {
+    wheel_type wheel;
+    std::vector<std::uint64_t> kept;
+    for (std::uint64_t i = 0; i < 40; ++i) {
+        // spread over the levels and the overflow list
+        const auto deadline = (i + 1) << (i % 40);
+        wheel.insert(deadline, static_cast<int>(i));
+        if (i % 2 == 0) kept.push_back(deadline);
+    }
+    CHECK_EQ(wheel.erase_if([](int value) { return value % 2 == 1; }), 20);
+    CHECK_EQ(wheel.size(), 20);
+
+    std::vector<wheel_type::entry> expired;
+    while (const auto next = wheel.next_tick()) wheel.advance(*next, expired);
+    std::ranges::sort(kept);
+    CHECK_EQ(deadlines(expired), kept);
+    CHECK(wheel.empty());
+}
+
+TEST_CASE("Ensure timer_wheel matches a sorted list of random deadlines") {
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<std::uint64_t> delays(0, 1'000'000);
+    wheel_type wheel;
+    std::vector<std::uint64_t> expected;
+    std::vector<wheel_type::entry> expired;
+
+    for (std::uint64_t now = 0; now < 2'000'000; now += 997) {
+        if (expected.size() < 5'000) {
+            for (auto i = 0; i < 10; ++i) {
+                const auto deadline = now + delays(generator);
+                wheel.insert(deadline, 0);
+                expected.push_back(std::max(deadline, wheel.current()));
+            }
+        }
+        wheel.advance(now, expired);
+    }
+    wheel.advance(10'000'000, expired);
+
+    std::ranges::sort(expected);
+    CHECK_EQ(deadlines(expired), expected);
+    CHECK(wheel.empty());
+}
@@ -0,0 +1,81 @@
+#include <doctest/doctest.h>
+#include <thread_pool/thread_pool.h>
+#include <thread_pool/victim_selection.h>
+
+#include <algorithm>
+#include <atomic>
+#include <ranges>
+#include <vector>
+
+TEST_CASE("Ensure victim orders contain every other worker exactly once") {
+    constexpr std::size_t worker_count = 8;
+    for (const auto policy : {dp::victim_selection::sequential, dp::victim_selection::randomized,
+                              dp::victim_selection::topology}) {
+        dp::details::victim_selector selector(policy, worker_count);
+        dp::details::victim_order order(selector, 3, 42);
+        for (int round = 0; round < 10; ++round) {
+            auto victims = order.next(worker_count);
+            CHECK_EQ(victims.size(), worker_count - 1);
+            std::ranges::sort(victims);
+            CHECK_EQ(std::ranges::adjacent_find(victims), victims.end());
+            CHECK_EQ(std::ranges::find(victims, 3), victims.end());
+        }
+        // adapts to a changing number of workers
+        CHECK_EQ(order.next(4).size(), 3);
+    }
+
+    dp::details::victim_selector selector(dp::victim_selection::sequential, 4);
+    dp::details::victim_order order(selector, 2, 42);
+    const std::vector<std::size_t> expected{3, 0, 1};
+    CHECK_EQ(order.next(4), expected);
+}
+
+TEST_CASE("Ensure topology victim selection prefers nearby workers") {
+    // cpus 0 and 1 share a core, cpus 0-3 share a cache and cpus 0-5 a node
+    dp::details::cpu_topology topology;
+    for (int cpu = 0; cpu < 8; ++cpu) topology.add_cpu(cpu, cpu / 2, cpu / 4, cpu < 6 ? 0 : 1);
+
+    constexpr std::size_t worker_count = 8;
+    dp::details::victim_selector selector(dp::victim_selection::topology, worker_count, topology);
+    REQUIRE_EQ(selector.policy(), dp::victim_selection::topology);
+    // worker i runs on cpu 7 - i
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        selector.update_cpu(i, static_cast<int>(worker_count - 1 - i));
+    }
+
+    dp::details::victim_order order(selector, 7, 42);
+    for (int round = 0; round < 10; ++round) {
+        const auto& victims = order.next(worker_count);
+        REQUIRE_EQ(victims.size(), worker_count - 1);
+        // worker 7 runs on cpu 0: worker 6 (cpu 1) shares its core
+        CHECK_EQ(victims[0], 6);
+        // then workers 4 and 5 (cpus 2 and 3) share the cache
+        CHECK(std::ranges::is_permutation(victims | std::views::drop(1) | std::views::take(2),
+                                          std::vector<std::size_t>{4, 5}));
+        // then workers 2 and 3 on the same node
+        CHECK(std::ranges::is_permutation(victims | std::views::drop(3) | std::views::take(2),
+                                          std::vector<std::size_t>{2, 3}));
+    }
+
+    // the order is updated when workers move
+    selector.update_cpu(0, 1);
+    CHECK_EQ(order.next(worker_count)[0], 0);
+}
+
+TEST_CASE("Ensure work completes with every victim selection policy") {
+    for (const auto policy : {dp::victim_selection::sequential, dp::victim_selection::randomized,
+                              dp::victim_selection::topology}) {
+        std::atomic_int counter{0};
+        constexpr auto total_tasks = 5'000;
+        {
+            dp::thread_pool pool({.thread_count = 4, .victims = policy});
+            pool.enqueue_detach([&pool, &counter] {
+                for (auto i = 0; i < total_tasks; ++i) {
+                    pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+                }
+            });
+            pool.wait_for_tasks();
+        }
+        CHECK_EQ(counter.load(), total_tasks);
+    }
+}
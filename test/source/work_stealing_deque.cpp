@@ -0,0 +1,212 @@
+#include <doctest/doctest.h>
+#include <thread_pool/work_stealing_deque.h>
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ensure work_stealing_deque keeps producers and consumers on separate cache lines") {
+    // top and bottom each start a cache line
+    CHECK_EQ(alignof(dp::work_stealing_deque<int>), dp::details::cache_line_size);
+    CHECK_GE(sizeof(dp::work_stealing_deque<int>), 2 * dp::details::cache_line_size);
+}
+
+TEST_CASE("Ensure work_stealing_deque pops in the right order") {
+    dp::work_stealing_deque<int> deque;
+    for (int i = 0; i < 5; ++i) deque.push_back(int(i));
+
+    CHECK_EQ(deque.size(), 5);
+    // oldest item is taken from the front
+    CHECK_EQ(deque.pop_front().value_or(-1), 0);
+    CHECK_EQ(deque.steal().value_or(-1), 1);
+    // newest item is taken from the back
+    CHECK_EQ(deque.pop_back().value_or(-1), 4);
+    CHECK_EQ(deque.pop_back().value_or(-1), 3);
+    CHECK_EQ(deque.pop_front().value_or(-1), 2);
+
+    CHECK(deque.empty());
+    CHECK_FALSE(deque.pop_front().has_value());
+    CHECK_FALSE(deque.pop_back().has_value());
+    CHECK_FALSE(deque.steal().has_value());
+}
+
+TEST_CASE("Ensure work_stealing_deque grows past its initial capacity") {
+    dp::work_stealing_deque<std::unique_ptr<int>> deque(4);
+    constexpr auto count = 1000;
+    for (int i = 0; i < count; ++i) deque.push_back(std::make_unique<int>(i));
+    CHECK_EQ(deque.size(), count);
+
+    for (int i = 0; i < count; ++i) {
+        auto item = deque.pop_front();
+        REQUIRE(item.has_value());
+        CHECK_EQ(**item, i);
+    }
+    CHECK(deque.empty());
+}
+
+TEST_CASE("Ensure work_stealing_deque clear() returns correct count") {
+    dp::work_stealing_deque<std::unique_ptr<int>> deque(2);
+    for (int i = 0; i < 10; ++i) deque.push_back(std::make_unique<int>(i));
+
+    CHECK_EQ(deque.clear(), 10);
+    CHECK(deque.empty());
+}
+
+TEST_CASE("Ensure every item is taken exactly once with thread contention") {
+    constexpr auto item_count = 20'000;
+    constexpr auto thief_count = 3;
+    dp::work_stealing_deque<int> deque(16);
+    std::vector<std::atomic_int> seen(item_count);
+    std::atomic_int taken{0};
+    std::barrier barrier(thief_count + 1);
+
+    {
+        std::vector<std::jthread> thieves;
+        for (int t = 0; t < thief_count; ++t) {
+            thieves.emplace_back([&] {
+                barrier.arrive_and_wait();
+                while (taken.load() < item_count) {
+                    if (auto item = deque.steal()) {
+                        seen[*item].fetch_add(1);
+                        taken.fetch_add(1);
+                    }
+                }
+            });
+        }
+
+        // the owner pushes and pops from the back while the thieves steal from the front
+        barrier.arrive_and_wait();
+        for (int i = 0; i < item_count; ++i) {
+            deque.push_back(int(i));
+            if (i % 3 == 0) {
+                if (auto item = deque.pop_back()) {
+                    seen[*item].fetch_add(1);
+                    taken.fetch_add(1);
+                }
+            }
+        }
+    }
+
+    CHECK(deque.empty());
+    CHECK_EQ(taken.load(), item_count);
+    CHECK(std::ranges::all_of(seen, [](const std::atomic_int& count) { return count == 1; }));
+}
+
+TEST_CASE("Ensure work_stealing_deque supports multiple producers") {
+    constexpr auto items_per_producer = 5'000;
+    constexpr auto producer_count = 3;
+    dp::work_stealing_deque<int> deque(8);
+    std::atomic_int64_t sum{0};
+    std::atomic_int taken{0};
+
+    {
+        std::vector<std::jthread> threads;
+        for (int p = 0; p < producer_count; ++p) {
+            threads.emplace_back([&deque] {
+                for (int i = 1; i <= items_per_producer; ++i) deque.push_back(int(i));
+            });
+        }
+        threads.emplace_back([&] {
+            while (taken.load() < items_per_producer * producer_count) {
+                if (auto item = deque.pop_front()) {
+                    sum.fetch_add(*item);
+                    taken.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    constexpr std::int64_t expected =
+        producer_count * (std::int64_t{items_per_producer} * (items_per_producer + 1) / 2);
+    CHECK_EQ(sum.load(), expected);
+    CHECK(deque.empty());
+}
+
+TEST_CASE("Ensure work_stealing_deque append_range() pushes all values in order") {
+    dp::work_stealing_deque<std::unique_ptr<int>> deque(2);
+    deque.push_back(std::make_unique<int>(0));
+
+    std::vector<std::unique_ptr<int>> values;
+    for (int i = 1; i < 100; ++i) values.push_back(std::make_unique<int>(i));
+    deque.append_range(std::ranges::subrange(std::make_move_iterator(values.begin()),
+                                             std::make_move_iterator(values.end())));
+    CHECK_EQ(deque.size(), 100);
+
+    for (int i = 0; i < 100; ++i) {
+        auto item = deque.pop_front();
+        REQUIRE(item.has_value());
+        CHECK_EQ(**item, i);
+    }
+    CHECK(deque.empty());
+}
+
+TEST_CASE("Ensure work_stealing_deque steal_batch() steals half of the items") {
+    dp::work_stealing_deque<std::unique_ptr<int>> victim(4);
+    dp::work_stealing_deque<std::unique_ptr<int>> thief(2);
+    for (int i = 0; i < 9; ++i) victim.push_back(std::make_unique<int>(i));
+
+    // items are stolen from the top, the oldest one is returned
+    std::size_t moved = 0;
+    auto stolen = victim.steal_batch(thief, &moved);
+    REQUIRE(stolen.has_value());
+    CHECK_EQ(**stolen, 0);
+    CHECK_EQ(moved, 4);
+    CHECK_EQ(thief.size(), 4);
+    for (int i = 1; i < 5; ++i) CHECK_EQ(*thief.pop_front().value(), i);
+    CHECK_EQ(victim.size(), 4);
+    for (int i = 5; i < 9; ++i) CHECK_EQ(*victim.pop_front().value(), i);
+
+    CHECK_FALSE(victim.steal_batch(thief).has_value());
+}
+
+TEST_CASE("Ensure every item is taken exactly once with batch stealing") {
+    constexpr auto item_count = 20'000;
+    constexpr auto thief_count = 3;
+    dp::work_stealing_deque<int> deque(16);
+    std::vector<std::unique_ptr<dp::work_stealing_deque<int>>> thief_deques;
+    for (int t = 0; t < thief_count; ++t) {
+        thief_deques.push_back(std::make_unique<dp::work_stealing_deque<int>>(16));
+    }
+    std::vector<std::atomic_int> seen(item_count);
+    std::atomic_int taken{0};
+
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < thief_count; ++t) {
+            threads.emplace_back([&, t] {
+                auto& own = *thief_deques[t];
+                auto& other = *thief_deques[(t + 1) % thief_count];
+                while (taken.load() < item_count) {
+                    auto item = own.pop_front();
+                    if (!item) item = deque.steal_batch(own);
+                    // thieves also steal from each other
+                    if (!item) item = other.steal_batch(own);
+                    if (item) {
+                        seen[*item].fetch_add(1);
+                        taken.fetch_add(1);
+                    }
+                }
+            });
+        }
+
+        // the owner keeps pushing and taking items from both ends
+        for (int i = 0; i < item_count; ++i) {
+            deque.push_back(int(i));
+            auto item = i % 5 == 0 ? deque.pop_back() : std::optional<int>{};
+            if (i % 7 == 0 && !item) item = deque.pop_front();
+            if (item) {
+                seen[*item].fetch_add(1);
+                taken.fetch_add(1);
+            }
+        }
+    }
+
+    CHECK_EQ(taken.load(), item_count);
+    CHECK(std::ranges::all_of(seen, [](const std::atomic_int& count) { return count == 1; }));
+}
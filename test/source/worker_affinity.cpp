@@ -0,0 +1,122 @@
+#include <doctest/doctest.h>
+#include <thread_pool/thread_pool.h>
+#include <thread_pool/worker_affinity.h>
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // 2 NUMA nodes with 2 cores each and 2 hardware threads per core: cpus 0-3 on node 0 and
+    // 4-7 on node 1, cpu n and n + 1 (n even) share a core
+    dp::details::cpu_topology make_topology() {
+        dp::details::cpu_topology topology;
+        for (int cpu = 0; cpu < 8; ++cpu) topology.add_cpu(cpu, cpu / 2 * 2, cpu / 4, cpu / 4);
+        return topology;
+    }
+
+    std::vector<int> first_cpus(const std::vector<std::vector<int>>& plan) {
+        std::vector<int> cpus;
+        for (const auto& set : plan) {
+            REQUIRE_EQ(set.size(), 1);
+            cpus.push_back(set.front());
+        }
+        return cpus;
+    }
+}  // namespace
+
+TEST_CASE("Ensure workers are not pinned by default") {
+    const std::vector allowed{0, 1, 2, 3};
+    CHECK(dp::details::plan_worker_cpus({}, 4, make_topology(), allowed).empty());
+}
+
+TEST_CASE("Ensure compact placement fills one NUMA node first") {
+    const std::vector allowed{7, 6, 5, 4, 3, 2, 1, 0};
+    const auto plan = dp::details::plan_worker_cpus(
+        {.placement = dp::worker_placement::compact}, 10, make_topology(), allowed);
+    const std::vector expected{0, 1, 2, 3, 4, 5, 6, 7, 0, 1};
+    CHECK_EQ(first_cpus(plan), expected);
+}
+
+TEST_CASE("Ensure spread placement alternates between NUMA nodes") {
+    const std::vector allowed{0, 1, 2, 3, 4, 5, 6, 7};
+    const auto plan = dp::details::plan_worker_cpus(
+        {.placement = dp::worker_placement::spread}, 4, make_topology(), allowed);
+    const std::vector expected{0, 4, 1, 5};
+    CHECK_EQ(first_cpus(plan), expected);
+}
+
+TEST_CASE("Ensure SMT siblings can be skipped") {
+    const std::vector allowed{0, 1, 2, 3, 4, 5, 6, 7};
+    const auto plan = dp::details::plan_worker_cpus(
+        {.placement = dp::worker_placement::spread, .skip_smt_siblings = true}, 4,
+        make_topology(), allowed);
+    const std::vector expected{0, 4, 2, 6};
+    CHECK_EQ(first_cpus(plan), expected);
+}
+
+TEST_CASE("Ensure placement can be restricted to a list of CPUs") {
+    const std::vector allowed{0, 1, 2, 3, 4, 5, 6, 7};
+    const auto plan = dp::details::plan_worker_cpus(
+        {.placement = dp::worker_placement::compact, .cpus = {6, 2, 2}}, 3, make_topology(),
+        allowed);
+    const std::vector expected{2, 6, 2};
+    CHECK_EQ(first_cpus(plan), expected);
+}
+
+TEST_CASE("Ensure explicit CPU sets take precedence") {
+    const std::vector<std::vector<int>> cpu_sets{{0, 1}, {2, 3}};
+    const auto plan = dp::details::plan_worker_cpus(
+        {.placement = dp::worker_placement::spread, .cpu_sets = cpu_sets}, 3, make_topology(),
+        {});
+    const std::vector<std::vector<int>> expected{{0, 1}, {2, 3}, {0, 1}};
+    CHECK_EQ(plan, expected);
+}
+
+TEST_CASE("Ensure workers are pinned to their CPUs") {
+    const auto allowed = dp::details::current_thread_cpus();
+    if (allowed.empty()) return;
+
+    std::mutex mutex;
+    std::vector<std::vector<int>> worker_cpus(4);
+    std::latch initialized(4);
+    {
+        dp::thread_pool pool({.thread_count = 4,
+                              .affinity = {.placement = dp::worker_placement::compact}},
+                             [&](std::size_t id) {
+                                 {
+                                     std::scoped_lock lock(mutex);
+                                     worker_cpus[id] = dp::details::current_thread_cpus();
+                                 }
+                                 initialized.count_down();
+                             });
+        initialized.wait();
+        std::atomic_int counter{0};
+        for (auto i = 0; i < 100; ++i) pool.enqueue_detach([&counter] { counter.fetch_add(1); });
+        pool.wait_for_tasks();
+        CHECK_EQ(counter.load(), 100);
+
+        for (std::size_t id = 0; id < pool.size(); ++id) {
+            const auto cpus = pool.worker_cpus(id);
+            REQUIRE_EQ(cpus.size(), 1);
+            CHECK(std::ranges::find(allowed, cpus.front()) != allowed.end());
+            std::scoped_lock lock(mutex);
+            CHECK_EQ(worker_cpus[id], std::vector{cpus.front()});
+        }
+    }
+
+    dp::thread_pool unpinned(2);
+    CHECK(unpinned.worker_cpus(0).empty());
+}
+
+TEST_CASE("Ensure workers that could not be pinned report no CPUs") {
+    // there is no such CPU, so pinning fails
+    constexpr int missing_cpu = 1 << 20;
+    std::latch initialized(1);
+    dp::thread_pool pool({.thread_count = 1, .affinity = {.cpu_sets = {{missing_cpu}}}},
+                         [&initialized](std::size_t) { initialized.count_down(); });
+    initialized.wait();
+    CHECK(pool.worker_cpus(0).empty());
+}
@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+#include <thread_pool/worker_signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST_CASE("Ensure worker_signal wait() returns right away after notify()") {
+    dp::details::worker_signal signal;
+    signal.notify();
+    // multiple notifications are coalesced
+    signal.notify();
+    signal.wait(dp::idle_strategy{});
+    CHECK_FALSE(signal.is_parked());
+}
+
+TEST_CASE("Ensure worker_signal wakes up a waiting thread") {
+    dp::idle_strategy strategy{};
+    SUBCASE("park right away") { strategy = {}; }
+    SUBCASE("spin then park") { strategy = {.spin_count = 100, .yield_count = 10}; }
+    SUBCASE("spin longer than the notification takes") {
+        strategy = {.spin_count = 1'000'000'000, .yield_count = 0};
+    }
+
+    dp::details::worker_signal signal;
+    std::atomic_int wake_count{0};
+    {
+        std::jthread waiter([&] {
+            for (int i = 0; i < 100; ++i) {
+                signal.wait(strategy);
+                wake_count.fetch_add(1);
+            }
+        });
+
+        for (int i = 0; i < 100; ++i) {
+            // wait for the waiter to consume the previous notification before sending the next
+            while (wake_count.load() < i) std::this_thread::yield();
+            signal.notify();
+        }
+    }
+    CHECK_EQ(wake_count.load(), 100);
+}
+
+TEST_CASE("Ensure worker_signal reports when the waiter is parked") {
+    dp::details::worker_signal signal;
+    std::jthread waiter([&] { signal.wait(dp::idle_strategy{}); });
+
+    while (!signal.is_parked()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    signal.notify();
+    waiter.join();
+    CHECK_FALSE(signal.is_parked());
+}